@@ -0,0 +1,141 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "LockstepGroup.hpp"
+#include <algorithm>
+#include <map>
+
+namespace Batch {
+    static void apply_buttons(GB::Core &core, uint8_t buttons) {
+        core.pad.clear_buttons();
+
+        for (int32_t i = 0; i < 8; ++i) {
+            core.pad.set_pad_state(static_cast<GB::PadButton>(i), buttons & (1 << i));
+        }
+    }
+
+    LockstepGroup::LockstepGroup(size_t lanes)
+        : lane_execution(std::max<size_t>(lanes, 1), 0),
+          lane_buttons(std::max<size_t>(lanes, 1), 0) {}
+
+    bool LockstepGroup::load(const std::filesystem::path &path) {
+        executions_.clear();
+
+        auto cart = GB::Cartridge::from_file(path);
+
+        if (!cart) {
+            return false;
+        }
+
+        executions_.push_back(start_execution(std::move(cart)));
+        std::fill(lane_execution.begin(), lane_execution.end(), 0);
+        std::fill(lane_buttons.begin(), lane_buttons.end(), 0);
+        return true;
+    }
+
+    size_t LockstepGroup::lanes() const { return lane_execution.size(); }
+
+    size_t LockstepGroup::executions() const { return executions_.size(); }
+
+    void LockstepGroup::set_buttons(size_t lane, uint8_t buttons) {
+        lane_buttons.at(lane) = buttons;
+    }
+
+    void LockstepGroup::run_for_frames(int32_t frames) {
+        if (executions_.empty() || frames <= 0) {
+            return;
+        }
+
+        split_diverged_lanes();
+
+        for (auto &execution : executions_) {
+            auto buttons = static_cast<uint8_t>(execution->buttons);
+            apply_buttons(*execution->core, buttons);
+            execution->core->run_for_frames(frames);
+            execution->buttons = -1;
+        }
+    }
+
+    GB::Core &LockstepGroup::core(size_t lane) {
+        return *executions_.at(lane_execution.at(lane))->core;
+    }
+
+    std::unique_ptr<LockstepGroup::Execution>
+    LockstepGroup::start_execution(std::unique_ptr<GB::Cartridge> cart) {
+        auto execution = std::make_unique<Execution>();
+        execution->cart = std::move(cart);
+        execution->core = std::make_unique<GB::Core>();
+        execution->core->set_audio_mode(GB::AudioMode::Silent);
+        execution->core->initialize(execution->cart.get());
+        return execution;
+    }
+
+    std::unique_ptr<LockstepGroup::Execution> LockstepGroup::fork_execution(Execution &parent) {
+        auto cart = parent.cart->share_image();
+
+        if (!cart) {
+            return nullptr;
+        }
+
+        auto child = start_execution(std::move(cart));
+        state.resize(parent.core->state_size());
+
+        if (!parent.core->save_state(state) || !child->core->load_state(state)) {
+            return nullptr;
+        }
+
+        return child;
+    }
+
+    void LockstepGroup::split_diverged_lanes() {
+        // Executions created this step, keyed by the one they came from and their buttons
+        std::map<std::pair<size_t, uint8_t>, size_t> forks{};
+
+        for (size_t lane = 0; lane < lane_execution.size(); ++lane) {
+            auto index = lane_execution[lane];
+            auto buttons = lane_buttons[lane];
+            auto &execution = *executions_[index];
+
+            if (execution.buttons == -1) {
+                execution.buttons = buttons;
+                continue;
+            }
+
+            if (execution.buttons == buttons) {
+                continue;
+            }
+
+            auto fork = forks.find({index, buttons});
+
+            if (fork == forks.end()) {
+                auto child = fork_execution(execution);
+
+                // Not expected for a ROM that already loaded, the lane stays with its current core
+                if (!child) {
+                    continue;
+                }
+
+                child->buttons = buttons;
+                fork = forks.emplace(std::pair{index, buttons}, executions_.size()).first;
+                executions_.push_back(std::move(child));
+            }
+
+            lane_execution[lane] = fork->second;
+        }
+    }
+}
@@ -0,0 +1,72 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "Cores/GB/Core.hpp"
+#include <cinttypes>
+#include <filesystem>
+#include <memory>
+#include <vector>
+
+namespace Batch {
+    // Many lanes running the same ROM. The core is deterministic, so lanes that were given the
+    // same buttons on every step so far are in the same state and share a single core. When the
+    // buttons of lanes sharing a core differ, the core keeps the first lane's buttons and each
+    // other combination gets a new core, on the same ROM image, with the shared core's state
+    // loaded into it. Lanes are experimental and meant for many copies that stay together for
+    // long stretches, every split copies a whole state.
+    class LockstepGroup {
+    public:
+        explicit LockstepGroup(size_t lanes);
+        ~LockstepGroup() = default;
+        LockstepGroup(const LockstepGroup &) = delete;
+        LockstepGroup(LockstepGroup &&) = delete;
+        LockstepGroup &operator=(const LockstepGroup &) = delete;
+        LockstepGroup &operator=(LockstepGroup &&) = delete;
+
+        // Puts every lane back on a single core at power on
+        bool load(const std::filesystem::path &rom_path);
+
+        size_t lanes() const;
+        // Cores currently running, at most one per lane
+        size_t executions() const;
+
+        // Held from the next run_for_frames on, bit n is GB::PadButton n
+        void set_buttons(size_t lane, uint8_t buttons);
+        void run_for_frames(int32_t frames);
+
+        // Shared with every lane in lockstep with this one, only read from it
+        GB::Core &core(size_t lane);
+
+    private:
+        struct Execution {
+            std::unique_ptr<GB::Cartridge> cart;
+            std::unique_ptr<GB::Core> core;
+            int32_t buttons = -1;
+        };
+
+        static std::unique_ptr<Execution> start_execution(std::unique_ptr<GB::Cartridge> cart);
+        std::unique_ptr<Execution> fork_execution(Execution &parent);
+        void split_diverged_lanes();
+
+        std::vector<std::unique_ptr<Execution>> executions_{};
+        std::vector<uint8_t> state{};
+        std::vector<size_t> lane_execution{};
+        std::vector<uint8_t> lane_buttons{};
+    };
+}
@@ -0,0 +1,237 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "SessionPool.hpp"
+#include <algorithm>
+#include <limits>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Batch {
+    constexpr size_t NO_WORK = std::numeric_limits<size_t>::max();
+
+    static void pin_current_thread(size_t cpu) {
+#ifdef _WIN32
+        constexpr size_t MASK_BITS = sizeof(DWORD_PTR) * 8;
+        SetThreadAffinityMask(GetCurrentThread(), static_cast<DWORD_PTR>(1) << (cpu % MASK_BITS));
+#elif defined(__linux__)
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu % CPU_SETSIZE, &set);
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+#else
+        (void)cpu;
+#endif
+    }
+
+    SessionPool::SessionPool(const SessionPoolOptions &options)
+        : capture(options.capture), sessions(std::max<size_t>(options.sessions, 1)) {
+        worker_count = std::clamp<size_t>(options.threads, 1, sessions.size());
+        size_t hardware_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+        ranges = std::make_unique<Range[]>(worker_count);
+
+        for (size_t i = 0; i < worker_count; ++i) {
+            ranges[i].begin = sessions.size() * i / worker_count;
+            ranges[i].end = sessions.size() * (i + 1) / worker_count;
+        }
+
+        if (capture & CAPTURE_FRAMEBUFFER) {
+            framebuffers.resize(sessions.size() * GB::FRAMEBUFFER_SIZE);
+        }
+
+        if (capture & CAPTURE_WORK_RAM) {
+            work_rams.resize(sessions.size() * WORK_RAM_SIZE);
+        }
+
+        // Workers report in once they have built the cores of their range
+        busy = worker_count;
+
+        for (size_t i = 0; i < worker_count; ++i) {
+            threads.emplace_back([this, i, pin = options.pin_threads, hardware_threads] {
+                if (pin) {
+                    pin_current_thread(i % hardware_threads);
+                }
+
+                run(i);
+            });
+        }
+
+        std::unique_lock lock(mutex);
+        done.wait(lock, [this] { return busy == 0; });
+    }
+
+    SessionPool::~SessionPool() {
+        {
+            std::lock_guard lock(mutex);
+            quit = true;
+        }
+
+        wake.notify_all();
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+    }
+
+    size_t SessionPool::size() const { return sessions.size(); }
+
+    size_t SessionPool::thread_count() const { return worker_count; }
+
+    GB::Core &SessionPool::core(size_t index) { return *sessions.at(index).core; }
+
+    bool SessionPool::load(size_t index, const std::filesystem::path &rom_path) {
+        auto &session = sessions.at(index);
+        auto cart = GB::Cartridge::from_file(rom_path);
+
+        if (!cart) {
+            return false;
+        }
+
+        session.core->ppu.set_render_enabled(capture & CAPTURE_FRAMEBUFFER);
+        session.core->set_audio_mode(GB::AudioMode::Silent);
+        session.core->initialize(cart.get());
+        session.cart = std::move(cart);
+        return true;
+    }
+
+    void SessionPool::unload(size_t index) {
+        auto &session = sessions.at(index);
+        session.core->initialize(nullptr);
+        session.cart.reset();
+    }
+
+    bool SessionPool::loaded(size_t index) const { return sessions.at(index).cart != nullptr; }
+
+    void SessionPool::reset(size_t index) {
+        auto &session = sessions.at(index);
+
+        if (session.cart) {
+            session.core->initialize(session.cart.get());
+        }
+    }
+
+    void SessionPool::run_for_frames(int32_t frames) {
+        std::unique_lock lock(mutex);
+
+        // Every worker is parked, nothing else touches the ranges
+        for (size_t i = 0; i < worker_count; ++i) {
+            ranges[i].next.store(ranges[i].begin, std::memory_order_relaxed);
+        }
+
+        frames_to_run = frames;
+        busy = worker_count;
+        ++generation;
+
+        lock.unlock();
+        wake.notify_all();
+        lock.lock();
+
+        done.wait(lock, [this] { return busy == 0; });
+    }
+
+    std::span<const uint8_t> SessionPool::framebuffer(size_t index) const {
+        if (framebuffers.empty()) {
+            return {};
+        }
+
+        return std::span(framebuffers).subspan(index * GB::FRAMEBUFFER_SIZE, GB::FRAMEBUFFER_SIZE);
+    }
+
+    std::span<const uint8_t> SessionPool::work_ram(size_t index) const {
+        if (work_rams.empty()) {
+            return {};
+        }
+
+        return std::span(work_rams).subspan(index * WORK_RAM_SIZE, WORK_RAM_SIZE);
+    }
+
+    void SessionPool::run(size_t worker) {
+        const auto &own = ranges[worker];
+
+        for (size_t i = own.begin; i < own.end; ++i) {
+            sessions[i].core = std::make_unique<GB::Core>();
+        }
+
+        std::unique_lock lock(mutex);
+        uint64_t seen = generation;
+
+        if (--busy == 0) {
+            done.notify_all();
+        }
+
+        while (true) {
+            wake.wait(lock, [&] { return generation != seen || quit; });
+
+            if (quit) {
+                return;
+            }
+
+            seen = generation;
+            lock.unlock();
+
+            // Own range first, then the others in order starting from the next worker
+            for (size_t r = 0; r < worker_count; ++r) {
+                auto &range = ranges[(worker + r) % worker_count];
+
+                for (size_t i = take_work(range); i != NO_WORK; i = take_work(range)) {
+                    run_session(i);
+                }
+            }
+
+            lock.lock();
+
+            if (--busy == 0) {
+                done.notify_all();
+            }
+        }
+    }
+
+    void SessionPool::run_session(size_t index) {
+        auto &session = sessions[index];
+
+        if (!session.cart) {
+            return;
+        }
+
+        session.core->run_for_frames(frames_to_run);
+
+        if (capture & CAPTURE_FRAMEBUFFER) {
+            auto pixels = session.core->ppu.framebuffer();
+            std::copy(pixels.begin(), pixels.end(),
+                      framebuffers.begin() + index * GB::FRAMEBUFFER_SIZE);
+        }
+
+        if (capture & CAPTURE_WORK_RAM) {
+            auto ram = session.core->bus.work_ram();
+            std::copy(ram.begin(), ram.end(), work_rams.begin() + index * WORK_RAM_SIZE);
+        }
+    }
+
+    size_t SessionPool::take_work(Range &range) {
+        size_t index = range.next.fetch_add(1, std::memory_order_relaxed);
+        return index < range.end ? index : NO_WORK;
+    }
+}
@@ -0,0 +1,113 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "Cores/GB/Core.hpp"
+#include <atomic>
+#include <cinttypes>
+#include <condition_variable>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace Batch {
+    constexpr uint32_t CAPTURE_FRAMEBUFFER = 1;
+    constexpr uint32_t CAPTURE_WORK_RAM = 2;
+
+    constexpr size_t WORK_RAM_SIZE = 32768;
+
+    struct SessionPoolOptions {
+        size_t sessions = 1;
+        size_t threads = std::thread::hardware_concurrency();
+        // Ties worker i to logical CPU i, only supported on Linux and Windows
+        bool pin_threads = false;
+        // What run_for_frames copies out of each core after stepping it
+        uint32_t capture = CAPTURE_FRAMEBUFFER;
+    };
+
+    // Owns a fixed number of cores and steps all of them together. Each worker starts on its own
+    // contiguous range of sessions, which it also constructed so their memory sits close to it,
+    // and steals from the other ranges once its own runs dry. Captured outputs land in buffers
+    // allocated once up front and stay valid until the next run_for_frames.
+    class SessionPool {
+    public:
+        explicit SessionPool(const SessionPoolOptions &options);
+        ~SessionPool();
+        SessionPool(const SessionPool &) = delete;
+        SessionPool(SessionPool &&) = delete;
+        SessionPool &operator=(const SessionPool &) = delete;
+        SessionPool &operator=(SessionPool &&) = delete;
+
+        size_t size() const;
+        size_t thread_count() const;
+
+        // Only safe to touch between calls to run_for_frames, e.g. to set the pad state
+        GB::Core &core(size_t index);
+
+        // The ROM image is shared with every other session that loads the same file
+        bool load(size_t index, const std::filesystem::path &rom_path);
+        void unload(size_t index);
+        bool loaded(size_t index) const;
+
+        // Starts the session over from power on with the same cartridge
+        void reset(size_t index);
+
+        // Advances every loaded session and captures its outputs, returns once all are done
+        void run_for_frames(int32_t frames);
+
+        // Empty when the pool was not asked to capture them
+        std::span<const uint8_t> framebuffer(size_t index) const;
+        std::span<const uint8_t> work_ram(size_t index) const;
+
+    private:
+        struct Session {
+            std::unique_ptr<GB::Core> core;
+            std::unique_ptr<GB::Cartridge> cart;
+        };
+
+        // Sessions [next, end) still waiting for a worker in the current step
+        struct alignas(64) Range {
+            std::atomic<size_t> next = 0;
+            size_t begin = 0, end = 0;
+        };
+
+        void run(size_t worker);
+        void run_session(size_t index);
+        size_t take_work(Range &range);
+
+        uint32_t capture = 0;
+        size_t worker_count = 0;
+        int32_t frames_to_run = 0;
+
+        std::vector<Session> sessions{};
+        std::unique_ptr<Range[]> ranges;
+        std::vector<uint8_t> framebuffers{};
+        std::vector<uint8_t> work_rams{};
+
+        std::mutex mutex;
+        std::condition_variable wake, done;
+        uint64_t generation = 0;
+        size_t busy = 0;
+        bool quit = false;
+
+        std::vector<std::thread> threads{};
+    };
+}
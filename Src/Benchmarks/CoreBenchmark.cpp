@@ -0,0 +1,673 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Batch/SessionPool.hpp"
+#include "Cores/GB/Constants.hpp"
+#include "Cores/GB/Core.hpp"
+#include "Cores/GB/Rewind.hpp"
+#include "Cores/GB/RunAhead.hpp"
+#include "Tests/RomBuilder.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr int32_t REPEATS = 3;
+    constexpr uint16_t LOOP_ADDRESS = 0x0200;
+    constexpr uint16_t DATA_ADDRESS = 0x7E00;
+    constexpr uint16_t RET_ADDRESS = 0x7F00;
+
+    struct Result {
+        std::string name;
+        double value = 0.0;
+        std::string unit;
+    };
+
+    struct Options {
+        std::filesystem::path output_path;
+        std::string filter;
+    };
+
+    // Best of a few runs, the minimum is the least disturbed by the rest of the system
+    template <typename Function> double best_time_ns(Function &&run) {
+        double best = std::numeric_limits<double>::max();
+
+        for (int32_t i = 0; i < REPEATS; ++i) {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            auto end = std::chrono::steady_clock::now();
+
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count());
+        }
+
+        return best;
+    }
+
+    // ROM only cartridge that runs setup once and then body in an endless loop. A RET is placed
+    // at RET_ADDRESS for call benchmarks, the VBlank vector returns immediately and DATA_ADDRESS
+    // is free for tables the setup code copies.
+    std::vector<uint8_t> make_rom(std::span<const uint8_t> setup, std::span<const uint8_t> body,
+                                  int32_t repeat) {
+        // LD HL,0xC000, then the benchmark's own setup
+        std::vector<uint8_t> program{0x21, 0x00, 0xC0};
+        program.insert(program.end(), setup.begin(), setup.end());
+
+        if (Tests::PROGRAM_ADDRESS + program.size() > LOOP_ADDRESS) {
+            std::fputs("benchmark setup does not fit\n", stderr);
+            std::exit(EXIT_FAILURE);
+        }
+
+        // Padded up to the loop with NOPs
+        std::vector<uint8_t> rom = Tests::make_rom(program);
+        size_t pc = LOOP_ADDRESS;
+
+        for (int32_t i = 0; i < repeat; ++i) {
+            pc = std::copy(body.begin(), body.end(), rom.begin() + pc) - rom.begin();
+        }
+
+        rom[pc++] = 0xC3; // JP LOOP_ADDRESS
+        rom[pc++] = LOOP_ADDRESS & 0xFF;
+        rom[pc++] = LOOP_ADDRESS >> 8;
+
+        rom[0x40] = 0xD9; // RETI
+        rom[RET_ADDRESS] = 0xC9;
+
+        return rom;
+    }
+
+    class TestRom {
+    public:
+        TestRom(std::string_view name, std::span<const uint8_t> rom)
+            : cart(GB::Cartridge::from_memory(rom)) {
+            if (!cart) {
+                std::fprintf(stderr, "Unable to load the %.*s ROM\n", static_cast<int>(name.size()),
+                             name.data());
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        GB::Cartridge *get() { return cart.get(); }
+
+    private:
+        std::unique_ptr<GB::Cartridge> cart;
+    };
+
+    class Suite {
+    public:
+        explicit Suite(std::string filter) : filter(std::move(filter)) {}
+
+        bool enabled(std::string_view name) const {
+            return filter.empty() || name.find(filter) != std::string_view::npos;
+        }
+
+        void add(std::string name, double value, std::string unit) {
+            std::fprintf(stderr, "%-28s %14.3f %s\n", name.c_str(), value, unit.c_str());
+            results.push_back({std::move(name), value, std::move(unit)});
+        }
+
+        const std::vector<Result> &get_results() const { return results; }
+
+    private:
+        std::string filter;
+        std::vector<Result> results{};
+    };
+
+    void ignore_samples(GB::Core &core) {
+        core.apu.set_samples_callback(GB::CPU_CLOCK_RATE / 48000, [](GB::SampleResult) {});
+    }
+
+    struct OpcodeClass {
+        std::string_view name;
+        std::vector<uint8_t> body;
+        // M-cycles of one body, which counts as one operation
+        int32_t m_cycles;
+    };
+
+    // Each class runs unrolled with the pixel pipeline and sample output off, so the result is
+    // the cost of the interpreter plus the per cycle bookkeeping every instruction pays.
+    void run_cpu_benchmarks(Suite &suite) {
+        const std::vector<OpcodeClass> classes{
+            {"nop", {0x00}, 1},
+            {"ld_r_r", {0x41}, 1},
+            {"alu_r", {0x80}, 1},
+            {"alu_imm", {0xC6, 0x01}, 2},
+            {"inc_r16", {0x03}, 2},
+            {"ld_r_hl", {0x7E}, 2},
+            {"ld_hl_r", {0x77}, 2},
+            {"push_pop", {0xC5, 0xC1}, 7},
+            {"jr", {0x18, 0x00}, 3},
+            {"call_ret", {0xCD, RET_ADDRESS & 0xFF, RET_ADDRESS >> 8}, 10},
+            {"cb_bit", {0xCB, 0x40}, 2},
+            {"cb_rotate", {0xCB, 0x00}, 2},
+        };
+
+        constexpr int32_t FRAMES = 120;
+
+        for (const auto &opcode : classes) {
+            std::string name = "cpu/" + std::string(opcode.name);
+
+            if (!suite.enabled(name)) {
+                continue;
+            }
+
+            TestRom rom(opcode.name, make_rom({}, opcode.body, 256));
+            GB::Core core;
+            core.ppu.set_render_enabled(false);
+            core.initialize(rom.get());
+            core.set_audio_mode(GB::AudioMode::Silent);
+            core.run_for_frames(10);
+
+            double ns = best_time_ns([&] { core.run_for_frames(FRAMES); });
+            double operations =
+                static_cast<double>(FRAMES) * GB::CYCLES_PER_FRAME / (4.0 * opcode.m_cycles);
+
+            suite.add(name, ns / operations, "ns/op");
+        }
+    }
+
+    void run_bus_benchmarks(Suite &suite) {
+        struct Region {
+            std::string_view name;
+            uint16_t address;
+        };
+
+        const std::array<Region, 7> regions{{
+            {"rom0", 0x0150},
+            {"romx", 0x4000},
+            {"vram", 0x8000},
+            {"wram0", 0xC000},
+            {"wramx", 0xD000},
+            {"io", 0xFF44},
+            {"hram", 0xFF80},
+        }};
+
+        constexpr int32_t ACCESSES = 1 << 22;
+
+        TestRom rom("bus", make_rom({}, std::array<uint8_t, 1>{0x00}, 1));
+        GB::Core core;
+        core.initialize(rom.get());
+
+        for (const auto &region : regions) {
+            std::string name = "bus/read_" + std::string(region.name);
+
+            if (suite.enabled(name)) {
+                volatile uint8_t sink = 0;
+                double ns = best_time_ns([&] {
+                    uint8_t sum = 0;
+                    for (int32_t i = 0; i < ACCESSES; ++i) {
+                        sum += core.bus.read(region.address + (i & 0x7F));
+                    }
+                    sink = sum;
+                });
+
+                suite.add(name, ns / ACCESSES, "ns/access");
+            }
+
+            // Writes to ROM would bank switch and writes to IO have side effects
+            if (region.address < 0x8000 || region.address == 0xFF44) {
+                continue;
+            }
+
+            name = "bus/write_" + std::string(region.name);
+
+            if (suite.enabled(name)) {
+                double ns = best_time_ns([&] {
+                    for (int32_t i = 0; i < ACCESSES; ++i) {
+                        core.bus.write(region.address + (i & 0x7F), static_cast<uint8_t>(i));
+                    }
+                });
+
+                suite.add(name, ns / ACCESSES, "ns/access");
+            }
+        }
+    }
+
+    // Fills the tile data, both tile maps and OAM so every layer has something to draw
+    void setup_ppu_scene(GB::Core &core, bool sprites, bool window) {
+        for (uint16_t address = 0x8000; address < 0x9800; ++address) {
+            core.bus.write(address, static_cast<uint8_t>(address * 37));
+        }
+
+        for (uint16_t address = 0x9800; address < 0xA000; ++address) {
+            core.bus.write(address, static_cast<uint8_t>(address));
+        }
+
+        // 40 tall objects, ten on each line of four bands
+        for (uint16_t i = 0; i < 40; ++i) {
+            core.bus.write(0xFE00 + i * 4, static_cast<uint8_t>(16 + (i / 10) * 36));
+            core.bus.write(0xFE01 + i * 4, static_cast<uint8_t>(8 + (i % 10) * 16));
+            core.bus.write(0xFE02 + i * 4, static_cast<uint8_t>(i * 2));
+            core.bus.write(0xFE03 + i * 4, static_cast<uint8_t>((i & 1) << 4));
+        }
+
+        core.bus.write(0xFF4A, 0);
+        core.bus.write(0xFF4B, 7);
+
+        uint8_t lcdc = 0x91;
+        lcdc |= sprites ? 0x06 : 0x00;
+        lcdc |= window ? 0x60 : 0x00;
+        core.bus.write(0xFF40, lcdc);
+    }
+
+    void run_ppu_benchmarks(Suite &suite) {
+        struct Scene {
+            std::string_view name;
+            bool sprites, window;
+        };
+
+        const std::array<Scene, 4> scenes{{
+            {"bg", false, false},
+            {"bg_sprites", true, false},
+            {"bg_window", false, true},
+            {"bg_sprites_window", true, true},
+        }};
+
+        constexpr int32_t FRAMES = 120;
+
+        TestRom rom("ppu", make_rom({}, std::array<uint8_t, 1>{0x00}, 1));
+
+        for (const auto &scene : scenes) {
+            std::string name = "ppu/frame_" + std::string(scene.name);
+
+            if (!suite.enabled(name)) {
+                continue;
+            }
+
+            GB::Core core;
+            core.initialize(rom.get());
+            setup_ppu_scene(core, scene.sprites, scene.window);
+
+            // Stepped on its own the same way the core does, one M-cycle at a time
+            double ns = best_time_ns([&] {
+                for (int32_t i = 0; i < FRAMES * (GB::CYCLES_PER_FRAME / 4); ++i) {
+                    core.ppu.step(4);
+                }
+            });
+
+            suite.add(name, ns / FRAMES, "ns/frame");
+            suite.add("ppu/line_" + std::string(scene.name), ns / (FRAMES * 154), "ns/line");
+        }
+    }
+
+    void run_apu_benchmarks(Suite &suite) {
+        constexpr int32_t CYCLES = GB::CPU_CLOCK_RATE;
+
+        if (!suite.enabled("apu/all_channels")) {
+            return;
+        }
+
+        TestRom rom("apu", make_rom({}, std::array<uint8_t, 1>{0x00}, 1));
+        GB::Core core;
+        core.initialize(rom.get());
+        ignore_samples(core);
+
+        // Power on, full volume on both sides and all four channels triggered
+        const std::array<std::pair<uint16_t, uint8_t>, 20> writes{{
+            {0xFF26, 0x80}, {0xFF24, 0x77}, {0xFF25, 0xFF}, {0xFF11, 0x80}, {0xFF12, 0xF0},
+            {0xFF13, 0x00}, {0xFF14, 0x87}, {0xFF16, 0x40}, {0xFF17, 0xF0}, {0xFF18, 0x80},
+            {0xFF19, 0x86}, {0xFF1A, 0x80}, {0xFF1C, 0x20}, {0xFF1D, 0x00}, {0xFF1E, 0x87},
+            {0xFF21, 0xF0}, {0xFF22, 0x33}, {0xFF23, 0x80}, {0xFF30, 0x01}, {0xFF31, 0x23},
+        }};
+
+        for (auto [address, value] : writes) {
+            core.bus.write(address, value);
+        }
+
+        double ns = best_time_ns([&] {
+            for (int32_t i = 0; i < CYCLES / 4; ++i) {
+                core.apu.step(4);
+            }
+        });
+
+        suite.add("apu/all_channels", CYCLES / (ns / 1e9), "cycles/s");
+    }
+
+    void run_dma_benchmarks(Suite &suite) {
+        constexpr int32_t TRANSFERS = 2000;
+
+        TestRom rom("dma", make_rom({}, std::array<uint8_t, 1>{0x00}, 1));
+        GB::Core core;
+        core.initialize(rom.get());
+        core.set_audio_mode(GB::AudioMode::Silent);
+
+        if (suite.enabled("dma/oam")) {
+            double ns = best_time_ns([&] {
+                for (int32_t i = 0; i < TRANSFERS * 100; ++i) {
+                    core.oam_dma.start(0xC0);
+                }
+            });
+
+            suite.add("dma/oam", ns / (TRANSFERS * 100), "ns/transfer");
+        }
+
+        // The largest general purpose transfer, 2 KiB from WRAM to VRAM. The timing includes
+        // the PPU running for the cycles the CPU is halted.
+        if (suite.enabled("dma/general_2k")) {
+            double ns = best_time_ns([&] {
+                for (int32_t i = 0; i < TRANSFERS; ++i) {
+                    core.dma.set_hdma1(0xC0);
+                    core.dma.set_hdma2(0x00);
+                    core.dma.set_hdma3(0x80);
+                    core.dma.set_hdma4(0x00);
+                    core.dma.set_dma_control(0x7F);
+                }
+            });
+
+            suite.add("dma/general_2k", ns / TRANSFERS, "ns/transfer");
+        }
+    }
+
+    // Whole frames with rendering and audio as a frontend runs them
+    void run_frame_benchmarks(Suite &suite) {
+        struct Program {
+            std::string_view name;
+            std::vector<uint8_t> setup;
+            std::vector<uint8_t> body;
+            int32_t repeat;
+        };
+
+        const std::vector<uint8_t> alu_loop{0x80, 0xC6, 0x01, 0xA8, 0x3C};
+
+        // Turns the LCD off, copies 160 bytes from DATA_ADDRESS to OAM and turns the LCD back
+        // on with tall objects enabled
+        const std::vector<uint8_t> load_objects{
+            0xAF, 0xE0, 0x40,                             // XOR A, LDH (LCDC),A
+            0x11, DATA_ADDRESS & 0xFF, DATA_ADDRESS >> 8, // LD DE,DATA_ADDRESS
+            0x21, 0x00, 0xFE,                             // LD HL,0xFE00
+            0x06, 0xA0,                                   // LD B,160
+            0x1A, 0x22, 0x13, 0x05, 0x20, 0xFA,           // Copy one byte, DEC B, JR NZ
+            0x3E, 0x97, 0xE0, 0x40,                       // LD A,0x97, LDH (LCDC),A
+        };
+
+        const std::vector<Program> programs{
+            // LD A,1, LDH (IE),A, EI, then HALT until every VBlank
+            {"halt", {0x3E, 0x01, 0xE0, 0xFF, 0xFB}, {0x76}, 1},
+            {"alu", {}, alu_loop, 64},
+            {"sprites", load_objects, alu_loop, 64},
+        };
+
+        constexpr int32_t FRAMES = 300;
+
+        for (const auto &program : programs) {
+            std::string name = "frame/" + std::string(program.name);
+
+            if (!suite.enabled(name)) {
+                continue;
+            }
+
+            auto image = make_rom(program.setup, program.body, program.repeat);
+
+            // Same layout as the PPU benchmark, ten objects on each line of four bands
+            for (size_t i = 0; i < 40; ++i) {
+                image[DATA_ADDRESS + i * 4] = static_cast<uint8_t>(16 + (i / 10) * 36);
+                image[DATA_ADDRESS + i * 4 + 1] = static_cast<uint8_t>(8 + (i % 10) * 16);
+                image[DATA_ADDRESS + i * 4 + 2] = static_cast<uint8_t>(i * 2);
+            }
+
+            TestRom rom(program.name, image);
+            GB::Core core;
+            core.initialize(rom.get());
+            ignore_samples(core);
+            core.run_for_frames(10);
+
+            double ns = best_time_ns([&] { core.run_for_frames(FRAMES); });
+            suite.add(name, FRAMES / (ns / 1e9), "frames/s");
+        }
+    }
+
+    // Many short steps across a session pool, the way bots and training runs drive it. Frames per
+    // second are summed over all sessions.
+    void run_batch_benchmarks(Suite &suite) {
+        constexpr int32_t STEPS = 120;
+
+        if (!suite.enabled("batch/step_1_frame")) {
+            return;
+        }
+
+        const std::vector<uint8_t> alu_loop{0x80, 0xC6, 0x01, 0xA8, 0x3C};
+
+        // The pool only loads sessions by path, the file is gone again once they have it
+        auto path = std::filesystem::temp_directory_path() / "bcb_bench_batch.gb";
+
+        {
+            auto rom = make_rom({}, alu_loop, 64);
+            std::ofstream file(path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<const char *>(rom.data()), rom.size());
+        }
+
+        Batch::SessionPoolOptions options{};
+        options.sessions = std::max<size_t>(std::thread::hardware_concurrency(), 1) * 4;
+        options.capture = Batch::CAPTURE_FRAMEBUFFER | Batch::CAPTURE_WORK_RAM;
+
+        Batch::SessionPool pool(options);
+
+        for (size_t i = 0; i < pool.size(); ++i) {
+            if (!pool.load(i, path)) {
+                std::fprintf(stderr, "Unable to load '%s'\n", path.string().c_str());
+                std::exit(EXIT_FAILURE);
+            }
+        }
+
+        std::error_code error{};
+        std::filesystem::remove(path, error);
+
+        pool.run_for_frames(10);
+
+        double ns = best_time_ns([&] {
+            for (int32_t i = 0; i < STEPS; ++i) {
+                pool.run_for_frames(1);
+            }
+        });
+
+        double frames = static_cast<double>(STEPS) * pool.size();
+        suite.add("batch/step_1_frame", frames / (ns / 1e9), "frames/s");
+        suite.add("batch/step_time", ns / STEPS, "ns/step");
+    }
+
+    // Save and load of a whole state with rendering on, as rewind and run-ahead use them
+    void run_state_benchmarks(Suite &suite) {
+        constexpr int32_t REPEATS = 1000;
+
+        if (!suite.enabled("state/save") && !suite.enabled("state/load")) {
+            return;
+        }
+
+        const std::vector<uint8_t> alu_loop{0x80, 0xC6, 0x01, 0xA8, 0x3C};
+        TestRom rom("state", make_rom({}, alu_loop, 64));
+        GB::Core core;
+        core.initialize(rom.get());
+        core.set_audio_mode(GB::AudioMode::Silent);
+        core.run_for_frames(10);
+
+        std::vector<uint8_t> state(core.state_size());
+        core.save_state(state);
+
+        double save_ns = best_time_ns([&] {
+            for (int32_t i = 0; i < REPEATS; ++i) {
+                core.save_state(state);
+            }
+        });
+
+        double load_ns = best_time_ns([&] {
+            for (int32_t i = 0; i < REPEATS; ++i) {
+                core.load_state(state);
+            }
+        });
+
+        suite.add("state/save", save_ns / REPEATS, "ns/op");
+        suite.add("state/load", load_ns / REPEATS, "ns/op");
+        suite.add("state/size", static_cast<double>(state.size()), "bytes");
+    }
+
+    // Time the emulation thread spends per captured frame, also as a share of the time it takes
+    // to emulate that frame, and compressed bytes per snapshot
+    void run_rewind_benchmarks(Suite &suite) {
+        constexpr int32_t FRAMES = 600;
+
+        if (!suite.enabled("rewind/capture")) {
+            return;
+        }
+
+        const std::vector<uint8_t> alu_loop{0x80, 0xC6, 0x01, 0xA8, 0x3C};
+        TestRom rom("rewind", make_rom({}, alu_loop, 64));
+        GB::Core core;
+        core.initialize(rom.get());
+        core.set_audio_mode(GB::AudioMode::Silent);
+        core.run_for_frames(10);
+
+        GB::RewindBuffer rewind{};
+        rewind.capture(core);
+
+        double frame_ns = best_time_ns([&] { core.run_for_frames(1); });
+        double capture_ns = best_time_ns([&] { rewind.capture(core); });
+
+        rewind.clear();
+
+        for (int32_t i = 0; i < FRAMES; ++i) {
+            core.run_for_frames(1);
+            rewind.capture(core);
+        }
+
+        double snapshot_bytes = static_cast<double>(rewind.memory_used()) / rewind.snapshot_count();
+
+        suite.add("rewind/capture", capture_ns, "ns/frame");
+        suite.add("rewind/capture_share", capture_ns / frame_ns * 100.0, "%");
+        suite.add("rewind/snapshot_size", snapshot_bytes, "bytes");
+    }
+
+    // Displayed frames per second with each run-ahead depth, audio on as a frontend runs it
+    void run_run_ahead_benchmarks(Suite &suite) {
+        constexpr int32_t FRAMES = 120;
+
+        const std::vector<uint8_t> alu_loop{0x80, 0xC6, 0x01, 0xA8, 0x3C};
+        TestRom rom("run_ahead", make_rom({}, alu_loop, 64));
+
+        for (int32_t depth = 0; depth <= 2; ++depth) {
+            std::string name = "run_ahead/" + std::to_string(depth);
+
+            if (!suite.enabled(name)) {
+                continue;
+            }
+
+            GB::Core core;
+            core.initialize(rom.get());
+            ignore_samples(core);
+            core.run_for_frames(10);
+
+            GB::RunAhead run_ahead{};
+            run_ahead.set_frames(depth);
+            run_ahead.prepare(core);
+
+            double ns = best_time_ns([&] {
+                for (int32_t i = 0; i < FRAMES; ++i) {
+                    run_ahead.run_frame(core);
+                }
+            });
+
+            suite.add(name, FRAMES / (ns / 1e9), "frames/s");
+        }
+    }
+
+    std::string json_escape(std::string_view text) {
+        std::string escaped;
+
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+
+            escaped += c;
+        }
+
+        return escaped;
+    }
+
+    void write_json(std::FILE *file, const std::vector<Result> &results) {
+        std::fprintf(file, "{\n  \"suite\": \"gb_core\",\n  \"version\": \"%s\",\n", BCB_VER);
+        std::fprintf(file, "  \"results\": [\n");
+
+        for (size_t i = 0; i < results.size(); ++i) {
+            const auto &result = results[i];
+            std::fprintf(file, "    {\"name\": \"%s\", \"value\": %.6g, \"unit\": \"%s\"}%s\n",
+                         json_escape(result.name).c_str(), result.value,
+                         json_escape(result.unit).c_str(), i + 1 < results.size() ? "," : "");
+        }
+
+        std::fprintf(file, "  ]\n}\n");
+    }
+}
+
+int main(int argc, char *argv[]) {
+    Options options{};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+
+        if (arg == "--output" && i + 1 < argc) {
+            options.output_path = argv[++i];
+        } else if (arg == "--filter" && i + 1 < argc) {
+            options.filter = argv[++i];
+        } else {
+            std::puts("usage: CoreBenchmark [options]\n"
+                      "  --output <path>   write the JSON report to a file instead of stdout\n"
+                      "  --filter <text>   only run benchmarks whose name contains text");
+            return EXIT_FAILURE;
+        }
+    }
+
+    Suite suite(options.filter);
+    run_cpu_benchmarks(suite);
+    run_bus_benchmarks(suite);
+    run_ppu_benchmarks(suite);
+    run_apu_benchmarks(suite);
+    run_dma_benchmarks(suite);
+    run_frame_benchmarks(suite);
+    run_batch_benchmarks(suite);
+    run_state_benchmarks(suite);
+    run_rewind_benchmarks(suite);
+    run_run_ahead_benchmarks(suite);
+
+    std::FILE *file = stdout;
+
+    if (!options.output_path.empty()) {
+        file = std::fopen(options.output_path.string().c_str(), "w");
+
+        if (!file) {
+            std::fprintf(stderr, "Unable to open '%s'\n", options.output_path.string().c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    write_json(file, suite.get_results());
+
+    if (file != stdout) {
+        std::fclose(file);
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,103 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "Cores/GB/AudioMixer.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+namespace {
+    constexpr size_t BLOCK_SIZE = 512;
+    constexpr size_t ITERATIONS = 20000;
+
+    using MixFunction = void (GB::AudioMixer::*)(const GB::SampleBlock &, const GB::MixerSettings &,
+                                                 std::span<float>);
+
+    double time_mix(MixFunction function, const GB::SampleBlock &block,
+                    const GB::MixerSettings &settings, std::vector<float> &output) {
+        GB::AudioMixer mixer;
+        mixer.set_sample_rate(48000);
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < ITERATIONS; ++i) {
+            (mixer.*function)(block, settings, output);
+        }
+        auto end = std::chrono::steady_clock::now();
+
+        auto elapsed = std::chrono::duration<double, std::nano>(end - start).count();
+        return elapsed / static_cast<double>(ITERATIONS * block.size());
+    }
+}
+
+int main() {
+    std::mt19937 rng(0xB16C0B0);
+    std::uniform_int_distribution<int> channel(0, 15);
+    std::uniform_int_distribution<int> master(0, 7);
+
+    GB::SampleBlock block;
+    block.resize(BLOCK_SIZE);
+
+    while (!block.full()) {
+        GB::SampleResult result{};
+        result.left_channel.master_volume = static_cast<uint8_t>(master(rng));
+        result.left_channel.pulse_1 = static_cast<uint8_t>(channel(rng));
+        result.left_channel.pulse_2 = static_cast<uint8_t>(channel(rng));
+        result.left_channel.wave = static_cast<uint8_t>(channel(rng));
+        result.left_channel.noise = static_cast<uint8_t>(channel(rng));
+        result.right_channel.master_volume = static_cast<uint8_t>(master(rng));
+        result.right_channel.pulse_1 = static_cast<uint8_t>(channel(rng));
+        result.right_channel.pulse_2 = static_cast<uint8_t>(channel(rng));
+        result.right_channel.wave = static_cast<uint8_t>(channel(rng));
+        result.right_channel.noise = static_cast<uint8_t>(channel(rng));
+        block.push(result);
+    }
+
+    GB::MixerSettings settings{};
+    settings.volume = 0.7f;
+    settings.channels = {1.0f, 0.8f, 0.6f, 0.4f};
+
+    std::vector<float> simd_output(BLOCK_SIZE * 2);
+    std::vector<float> scalar_output(BLOCK_SIZE * 2);
+
+    GB::AudioMixer simd_mixer, scalar_mixer;
+    simd_mixer.set_sample_rate(48000);
+    scalar_mixer.set_sample_rate(48000);
+
+    float max_error = 0.0f;
+    for (size_t i = 0; i < 64; ++i) {
+        simd_mixer.mix(block, settings, simd_output);
+        scalar_mixer.mix_scalar(block, settings, scalar_output);
+
+        for (size_t s = 0; s < simd_output.size(); ++s) {
+            max_error = std::max(max_error, std::abs(simd_output[s] - scalar_output[s]));
+        }
+    }
+
+    double simd_ns = time_mix(&GB::AudioMixer::mix, block, settings, simd_output);
+    double scalar_ns = time_mix(&GB::AudioMixer::mix_scalar, block, settings, scalar_output);
+
+    std::printf("mix        %8.3f ns/sample\n", simd_ns);
+    std::printf("mix_scalar %8.3f ns/sample\n", scalar_ns);
+    std::printf("speedup    %8.2fx\n", scalar_ns / simd_ns);
+    std::printf("max error  %g\n", max_error);
+
+    return max_error <= 1e-5f ? 0 : 1;
+}
@@ -0,0 +1,276 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "BigComBoy.h"
+#include "Cores/GB/AudioMixer.hpp"
+#include "Cores/GB/Constants.hpp"
+#include "Cores/GB/Core.hpp"
+#include <memory>
+#include <new>
+#include <span>
+#include <vector>
+
+static_assert(BCB_SCREEN_WIDTH == GB::LCD_WIDTH && BCB_SCREEN_HEIGHT == GB::LCD_HEIGHT);
+
+struct bcb_core {
+    static constexpr size_t AUDIO_BLOCK_FRAMES = 512;
+
+    GB::Core core{};
+    std::unique_ptr<GB::Cartridge> cart;
+    uint32_t buttons = 0;
+
+    int32_t sample_rate = 0;
+    GB::SampleBlock block{};
+    GB::AudioMixer mixer{};
+    GB::MixerSettings settings{};
+    // Interleaved stereo output of the last run call
+    std::vector<float> audio{};
+
+    // Mixes whatever the block holds onto the end of the output
+    void flush_audio() {
+        if (block.size() == 0) {
+            return;
+        }
+
+        size_t offset = audio.size();
+        audio.resize(offset + block.size() * 2);
+        mixer.mix(block, settings, std::span(audio).subspan(offset));
+        block.clear();
+    }
+
+    void start_audio() {
+        if (sample_rate == 0) {
+            core.set_audio_mode(GB::AudioMode::Silent);
+            core.apu.set_samples_callback(GB::CPU_CLOCK_RATE / 48000, nullptr);
+            return;
+        }
+
+        block.resize(AUDIO_BLOCK_FRAMES);
+        block.clear();
+        mixer.set_sample_rate(sample_rate);
+        mixer.reset();
+
+        core.set_audio_mode(GB::AudioMode::Full);
+        core.apu.set_samples_callback(GB::CPU_CLOCK_RATE / sample_rate,
+                                      [this](GB::SampleResult result) {
+                                          block.push(result);
+
+                                          if (block.full()) {
+                                              flush_audio();
+                                          }
+                                      });
+    }
+
+    void apply_buttons() {
+        core.pad.clear_buttons();
+
+        for (int32_t i = 0; i < 8; ++i) {
+            core.pad.set_pad_state(static_cast<GB::PadButton>(i), buttons & (1u << i));
+        }
+    }
+};
+
+// Nothing thrown inside the core may cross into C
+template <typename Function> static int32_t guarded(Function &&function) {
+    try {
+        return function();
+    } catch (const std::bad_alloc &) {
+        return BCB_ERROR_OUT_OF_MEMORY;
+    } catch (...) {
+        return BCB_ERROR_INVALID_ARGUMENT;
+    }
+}
+
+uint32_t bcb_api_version(void) { return BCB_API_VERSION; }
+
+bcb_core *bcb_create(void) {
+    try {
+        auto core = std::make_unique<bcb_core>();
+        core->start_audio();
+        return core.release();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void bcb_destroy(bcb_core *core) { delete core; }
+
+int32_t bcb_load_rom(bcb_core *core, const uint8_t *data, size_t size) {
+    if (!core || !data || size == 0) {
+        return BCB_ERROR_INVALID_ARGUMENT;
+    }
+
+    return guarded([&] {
+        auto cart = GB::Cartridge::from_memory(std::span(data, size));
+
+        if (!cart) {
+            return BCB_ERROR_INVALID_ROM;
+        }
+
+        core->core.initialize(cart.get());
+        core->cart = std::move(cart);
+        core->audio.clear();
+        core->start_audio();
+        return BCB_OK;
+    });
+}
+
+int32_t bcb_reset(bcb_core *core) {
+    if (!core) {
+        return BCB_ERROR_INVALID_ARGUMENT;
+    } else if (!core->cart) {
+        return BCB_ERROR_NO_ROM;
+    }
+
+    core->core.initialize(core->cart.get());
+    core->audio.clear();
+    core->start_audio();
+    return BCB_OK;
+}
+
+void bcb_set_buttons(bcb_core *core, uint32_t buttons) {
+    if (core) {
+        core->buttons = buttons & 0xFF;
+    }
+}
+
+int32_t bcb_run_frames(bcb_core *core, int32_t frames) {
+    if (!core || frames < 0) {
+        return BCB_ERROR_INVALID_ARGUMENT;
+    } else if (!core->cart) {
+        return BCB_ERROR_NO_ROM;
+    }
+
+    return guarded([&] {
+        core->audio.clear();
+        core->apply_buttons();
+        core->core.run_for_frames(frames);
+        core->flush_audio();
+        return BCB_OK;
+    });
+}
+
+int32_t bcb_run_cycles(bcb_core *core, int32_t cycles) {
+    if (!core || cycles < 0) {
+        return BCB_ERROR_INVALID_ARGUMENT;
+    } else if (!core->cart) {
+        return BCB_ERROR_NO_ROM;
+    }
+
+    return guarded([&] {
+        core->audio.clear();
+        core->apply_buttons();
+        core->core.run_for_cycles(cycles);
+        core->flush_audio();
+        return BCB_OK;
+    });
+}
+
+const uint8_t *bcb_framebuffer(bcb_core *core) {
+    if (!core) {
+        return nullptr;
+    }
+
+    try {
+        return core->core.ppu.framebuffer().data();
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+int32_t bcb_set_audio_rate(bcb_core *core, int32_t sample_rate) {
+    if (!core || sample_rate < 0 || sample_rate > GB::CPU_CLOCK_RATE) {
+        return BCB_ERROR_INVALID_ARGUMENT;
+    }
+
+    return guarded([&] {
+        core->sample_rate = sample_rate;
+        core->audio.clear();
+        core->start_audio();
+        return BCB_OK;
+    });
+}
+
+const float *bcb_audio_samples(bcb_core *core, size_t *frames) {
+    if (!core) {
+        if (frames) {
+            *frames = 0;
+        }
+
+        return nullptr;
+    }
+
+    if (frames) {
+        *frames = core->audio.size() / 2;
+    }
+
+    return core->audio.data();
+}
+
+uint8_t bcb_read_memory(bcb_core *core, uint16_t address) {
+    if (!core || !core->cart) {
+        return 0xFF;
+    }
+
+    return core->core.bus.read(address);
+}
+
+void bcb_write_memory(bcb_core *core, uint16_t address, uint8_t value) {
+    if (core && core->cart) {
+        core->core.bus.write(address, value);
+    }
+}
+
+size_t bcb_state_size(bcb_core *core) {
+    if (!core || !core->cart) {
+        return 0;
+    }
+
+    return core->core.state_size();
+}
+
+int32_t bcb_save_state(bcb_core *core, uint8_t *buffer, size_t size) {
+    if (!core || !buffer) {
+        return BCB_ERROR_INVALID_ARGUMENT;
+    } else if (!core->cart) {
+        return BCB_ERROR_NO_ROM;
+    }
+
+    return guarded([&] {
+        bool saved = core->core.save_state(std::span(buffer, size));
+        return saved ? BCB_OK : BCB_ERROR_INVALID_ARGUMENT;
+    });
+}
+
+int32_t bcb_load_state(bcb_core *core, const uint8_t *buffer, size_t size) {
+    if (!core || !buffer) {
+        return BCB_ERROR_INVALID_ARGUMENT;
+    } else if (!core->cart) {
+        return BCB_ERROR_NO_ROM;
+    }
+
+    return guarded([&] {
+        if (!core->core.load_state(std::span(buffer, size))) {
+            return BCB_ERROR_INVALID_ARGUMENT;
+        }
+
+        core->audio.clear();
+        core->block.clear();
+        return BCB_OK;
+    });
+}
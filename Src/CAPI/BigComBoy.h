@@ -0,0 +1,116 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+    C interface to the Game Boy core for use through FFI. Functions never throw and report
+    failure through BCB_ERROR_* codes. A core handle may be used from any thread but only from
+    one at a time, separate handles are independent.
+
+    Pointers returned by bcb_framebuffer and bcb_audio_samples point into the core and are
+    not copies. They stay valid until the next call that runs, resets, loads into or destroys
+    that core.
+
+    Existing functions keep their signatures, additions raise BCB_API_VERSION.
+*/
+
+#if defined(_WIN32)
+#if defined(BCB_BUILDING_LIBRARY)
+#define BCB_API __declspec(dllexport)
+#else
+#define BCB_API __declspec(dllimport)
+#endif
+#else
+#define BCB_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BCB_API_VERSION 1
+
+#define BCB_OK 0
+#define BCB_ERROR_INVALID_ARGUMENT -1
+#define BCB_ERROR_INVALID_ROM -2
+#define BCB_ERROR_NO_ROM -3
+#define BCB_ERROR_OUT_OF_MEMORY -4
+#define BCB_ERROR_UNSUPPORTED -5
+
+/* Bits of the button mask passed to bcb_set_buttons */
+#define BCB_BUTTON_LEFT 0x01
+#define BCB_BUTTON_RIGHT 0x02
+#define BCB_BUTTON_UP 0x04
+#define BCB_BUTTON_DOWN 0x08
+#define BCB_BUTTON_A 0x10
+#define BCB_BUTTON_B 0x20
+#define BCB_BUTTON_SELECT 0x40
+#define BCB_BUTTON_START 0x80
+
+#define BCB_SCREEN_WIDTH 160
+#define BCB_SCREEN_HEIGHT 144
+
+typedef struct bcb_core bcb_core;
+
+/* BCB_API_VERSION of the library that was loaded, which can be newer than the header */
+BCB_API uint32_t bcb_api_version(void);
+
+/* Returns NULL when out of memory */
+BCB_API bcb_core *bcb_create(void);
+BCB_API void bcb_destroy(bcb_core *core);
+
+/* The ROM is copied and the core starts from power on. No battery file is used. */
+BCB_API int32_t bcb_load_rom(bcb_core *core, const uint8_t *data, size_t size);
+BCB_API int32_t bcb_reset(bcb_core *core);
+
+/* Held until changed, a mask of BCB_BUTTON_* */
+BCB_API void bcb_set_buttons(bcb_core *core, uint32_t buttons);
+
+BCB_API int32_t bcb_run_frames(bcb_core *core, int32_t frames);
+/* Runs whole instructions until at least cycles T-cycles have passed */
+BCB_API int32_t bcb_run_cycles(bcb_core *core, int32_t cycles);
+
+/* Last completed frame, BCB_SCREEN_WIDTH * BCB_SCREEN_HEIGHT pixels of 8-bit RGBA by rows */
+BCB_API const uint8_t *bcb_framebuffer(bcb_core *core);
+
+/*
+    Audio is off until a sample rate is set, 0 turns it off again. While it is on, every run
+    call produces interleaved stereo float samples, bcb_audio_samples returns them along with
+    the number of stereo frames.
+*/
+BCB_API int32_t bcb_set_audio_rate(bcb_core *core, int32_t sample_rate);
+BCB_API const float *bcb_audio_samples(bcb_core *core, size_t *frames);
+
+/* Goes through the bus as the CPU would, including register side effects */
+BCB_API uint8_t bcb_read_memory(bcb_core *core, uint16_t address);
+BCB_API void bcb_write_memory(bcb_core *core, uint16_t address, uint8_t value);
+
+/*
+    Size of the buffer bcb_save_state needs, 0 without a ROM. States only load into a core
+    running the same ROM, loading one that fails part way through needs a bcb_reset after.
+*/
+BCB_API size_t bcb_state_size(bcb_core *core);
+BCB_API int32_t bcb_save_state(bcb_core *core, uint8_t *buffer, size_t size);
+BCB_API int32_t bcb_load_state(bcb_core *core, const uint8_t *buffer, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
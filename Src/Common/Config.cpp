@@ -48,6 +48,10 @@ namespace Common {
             {"allow_sram_saving", gameboy.emulation.allow_sram_saving},
             {"use_rpc", gameboy.emulation.use_rpc},
             {"sram_save_interval", gameboy.emulation.sram_save_interval},
+            {"rewind_enabled", gameboy.emulation.rewind_enabled},
+            {"rewind_seconds", gameboy.emulation.rewind_seconds},
+            {"rewind_memory_mb", gameboy.emulation.rewind_memory_mb},
+            {"run_ahead_frames", gameboy.emulation.run_ahead_frames},
             {"frame_blending", gameboy.video.frame_blending},
             {"smooth_scaling", gameboy.video.smooth_scaling},
             {"screen_filter", gameboy.video.screen_filter},
@@ -129,6 +133,15 @@ namespace Common {
         gameboy.emulation.sram_save_interval =
             toml::find_or(gb, "sram_save_interval", gameboy.emulation.sram_save_interval);
 
+        gameboy.emulation.rewind_enabled =
+            toml::find_or(gb, "rewind_enabled", gameboy.emulation.rewind_enabled);
+        gameboy.emulation.rewind_seconds =
+            toml::find_or(gb, "rewind_seconds", gameboy.emulation.rewind_seconds);
+        gameboy.emulation.rewind_memory_mb =
+            toml::find_or(gb, "rewind_memory_mb", gameboy.emulation.rewind_memory_mb);
+        gameboy.emulation.run_ahead_frames =
+            toml::find_or(gb, "run_ahead_frames", gameboy.emulation.run_ahead_frames);
+
         gameboy.video.frame_blending =
             toml::find_or(gb, "frame_blending", gameboy.video.frame_blending);
         gameboy.video.smooth_scaling =
@@ -46,6 +46,12 @@ namespace Common {
             bool allow_sram_saving = true;
             bool use_rpc = true;
             int32_t sram_save_interval = 30;
+
+            bool rewind_enabled = false;
+            int32_t rewind_seconds = 30;
+            int32_t rewind_memory_mb = 128;
+
+            int32_t run_ahead_frames = 0;
         } emulation;
 
         struct AudioData {
@@ -0,0 +1,108 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Common {
+    // Fixed set of workers draining a shared queue of jobs
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t thread_count = std::thread::hardware_concurrency()) {
+            thread_count = std::max<size_t>(thread_count, 1);
+
+            for (size_t i = 0; i < thread_count; ++i) {
+                threads.emplace_back([this] { run(); });
+            }
+        }
+
+        ~ThreadPool() {
+            {
+                std::lock_guard lock(mutex);
+                quit = true;
+            }
+
+            wake.notify_all();
+
+            for (auto &thread : threads) {
+                thread.join();
+            }
+        }
+
+        ThreadPool(const ThreadPool &) = delete;
+        ThreadPool(ThreadPool &&) = delete;
+        ThreadPool &operator=(const ThreadPool &) = delete;
+        ThreadPool &operator=(ThreadPool &&) = delete;
+
+        size_t thread_count() const { return threads.size(); }
+
+        void submit(std::function<void()> job) {
+            {
+                std::lock_guard lock(mutex);
+                jobs.push_back(std::move(job));
+            }
+
+            wake.notify_one();
+        }
+
+        // Blocks until every submitted job has finished
+        void wait() {
+            std::unique_lock lock(mutex);
+            idle.wait(lock, [this] { return jobs.empty() && active == 0; });
+        }
+
+    private:
+        void run() {
+            std::unique_lock lock(mutex);
+
+            while (true) {
+                wake.wait(lock, [this] { return !jobs.empty() || quit; });
+
+                if (jobs.empty()) {
+                    return;
+                }
+
+                auto job = std::move(jobs.front());
+                jobs.pop_front();
+                ++active;
+
+                lock.unlock();
+                job();
+                lock.lock();
+
+                if (--active == 0 && jobs.empty()) {
+                    idle.notify_all();
+                }
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable wake, idle;
+        std::deque<std::function<void()>> jobs{};
+        size_t active = 0;
+        bool quit = false;
+
+        std::vector<std::thread> threads{};
+    };
+}
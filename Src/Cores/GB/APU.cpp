@@ -17,6 +17,7 @@
 */
 
 #include "APU.hpp"
+#include "State.hpp"
 #include <array>
 
 namespace GB {
@@ -908,4 +909,10 @@ namespace GB {
         frame_sequencer_counter = ++frame_sequencer_counter & 7;
     }
 
+    void APU::serialize(StateArchive &archive) {
+        archive(mix_vin_left, mix_vin_right, power, stereo_left_volume, stereo_right_volume,
+                frame_sequencer_counter, wave_table);
+        archive(pulse_1, pulse_2, wave, noise, sample_counter);
+    }
+
 }
\ No newline at end of file
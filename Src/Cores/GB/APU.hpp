@@ -22,6 +22,8 @@
 #include <functional>
 
 namespace GB {
+    class StateArchive;
+
     class LengthCounter {
     public:
         void step_length(bool &channel_on);
@@ -206,6 +208,11 @@ namespace GB {
 
         void step(int32_t cycles);
         void step_frame_sequencer();
+        // 0-7, the step the frame sequencer takes next
+        uint8_t frame_sequencer_step() const { return frame_sequencer_counter; }
+
+        // The sample rate and callback belong to the frontend and are left as they are
+        void serialize(StateArchive &archive);
 
     private:
         bool mix_vin_left = false;
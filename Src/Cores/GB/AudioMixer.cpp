@@ -0,0 +1,224 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "AudioMixer.hpp"
+#include "Constants.hpp"
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#define GB_MIXER_SSE
+#include <xmmintrin.h>
+#endif
+
+namespace GB {
+    // Channel outputs are 0-15 and NR50 volumes are 0-7. Each channel is scaled by 1/255 and
+    // the NR50 volume by 1/7 as the SDL mixing this replaced did, so all four channels at full
+    // volume peak at 60/255 (~0.235) and levels match earlier versions.
+    constexpr float CHANNEL_SCALE = 1.0f / (255.0f * 7.0f);
+
+    // Per T-cycle capacitor charge of the DMG output high-pass filter
+    constexpr double HPF_CHARGE_PER_CYCLE = 0.999958;
+
+    size_t SampleBlock::size() const { return count; }
+
+    size_t SampleBlock::capacity() const { return left_master.size(); }
+
+    bool SampleBlock::full() const { return count == left_master.size(); }
+
+    void SampleBlock::resize(size_t new_capacity) {
+        for (auto &channel : left) {
+            channel.resize(new_capacity);
+        }
+
+        for (auto &channel : right) {
+            channel.resize(new_capacity);
+        }
+
+        left_master.resize(new_capacity);
+        right_master.resize(new_capacity);
+        count = 0;
+    }
+
+    void SampleBlock::clear() { count = 0; }
+
+    void SampleBlock::push(const SampleResult &result) {
+        if (full()) {
+            return;
+        }
+
+        left[0][count] = result.left_channel.pulse_1;
+        left[1][count] = result.left_channel.pulse_2;
+        left[2][count] = result.left_channel.wave;
+        left[3][count] = result.left_channel.noise;
+        left_master[count] = result.left_channel.master_volume;
+
+        right[0][count] = result.right_channel.pulse_1;
+        right[1][count] = result.right_channel.pulse_2;
+        right[2][count] = result.right_channel.wave;
+        right[3][count] = result.right_channel.noise;
+        right_master[count] = result.right_channel.master_volume;
+
+        ++count;
+    }
+
+    void AudioMixer::reset() {
+        left_capacitor = 0.0f;
+        right_capacitor = 0.0f;
+    }
+
+    void AudioMixer::set_sample_rate(int32_t rate) {
+        double cycles_per_sample = static_cast<double>(CPU_CLOCK_RATE) / rate;
+        charge_factor = static_cast<float>(std::pow(HPF_CHARGE_PER_CYCLE, cycles_per_sample));
+    }
+
+    void AudioMixer::mix(const SampleBlock &block, const MixerSettings &settings,
+                         std::span<float> output) {
+#ifdef GB_MIXER_SSE
+        const size_t count = block.size();
+
+        if (output.size() < count * 2) {
+            throw std::invalid_argument("Output span is too small for the sample block.");
+        }
+
+        mixed_left.resize(block.capacity());
+        mixed_right.resize(block.capacity());
+
+        __m128 gains[MIXER_CHANNELS];
+        std::array<float, MIXER_CHANNELS> scalar_gains{};
+
+        for (size_t c = 0; c < MIXER_CHANNELS; ++c) {
+            scalar_gains[c] = settings.channels[c] * CHANNEL_SCALE;
+            gains[c] = _mm_set1_ps(scalar_gains[c]);
+        }
+
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 left = _mm_setzero_ps();
+            __m128 right = _mm_setzero_ps();
+
+            for (size_t c = 0; c < MIXER_CHANNELS; ++c) {
+                left = _mm_add_ps(left, _mm_mul_ps(_mm_loadu_ps(&block.left[c][i]), gains[c]));
+                right = _mm_add_ps(right, _mm_mul_ps(_mm_loadu_ps(&block.right[c][i]), gains[c]));
+            }
+
+            _mm_storeu_ps(&mixed_left[i], _mm_mul_ps(left, _mm_loadu_ps(&block.left_master[i])));
+            _mm_storeu_ps(&mixed_right[i],
+                          _mm_mul_ps(right, _mm_loadu_ps(&block.right_master[i])));
+        }
+
+        for (; i < count; ++i) {
+            float left = 0.0f, right = 0.0f;
+
+            for (size_t c = 0; c < MIXER_CHANNELS; ++c) {
+                left += block.left[c][i] * scalar_gains[c];
+                right += block.right[c][i] * scalar_gains[c];
+            }
+
+            mixed_left[i] = left * block.left_master[i];
+            mixed_right[i] = right * block.right_master[i];
+        }
+
+        // The filter is recursive so it stays scalar, everything around it is vectorized
+        high_pass(count);
+
+        const __m128 volume = _mm_set1_ps(settings.volume);
+        const __m128 lower = _mm_set1_ps(-1.0f);
+        const __m128 upper = _mm_set1_ps(1.0f);
+
+        i = 0;
+        for (; i + 4 <= count; i += 4) {
+            __m128 left = _mm_mul_ps(_mm_loadu_ps(&mixed_left[i]), volume);
+            __m128 right = _mm_mul_ps(_mm_loadu_ps(&mixed_right[i]), volume);
+
+            left = _mm_min_ps(_mm_max_ps(left, lower), upper);
+            right = _mm_min_ps(_mm_max_ps(right, lower), upper);
+
+            _mm_storeu_ps(&output[i * 2], _mm_unpacklo_ps(left, right));
+            _mm_storeu_ps(&output[i * 2 + 4], _mm_unpackhi_ps(left, right));
+        }
+
+        for (; i < count; ++i) {
+            output[i * 2] = std::clamp(mixed_left[i] * settings.volume, -1.0f, 1.0f);
+            output[i * 2 + 1] = std::clamp(mixed_right[i] * settings.volume, -1.0f, 1.0f);
+        }
+#else
+        mix_scalar(block, settings, output);
+#endif
+    }
+
+    void AudioMixer::mix_scalar(const SampleBlock &block, const MixerSettings &settings,
+                                std::span<float> output) {
+        const size_t count = block.size();
+
+        if (output.size() < count * 2) {
+            throw std::invalid_argument("Output span is too small for the sample block.");
+        }
+
+        std::array<float, MIXER_CHANNELS> gains{};
+
+        for (size_t c = 0; c < MIXER_CHANNELS; ++c) {
+            gains[c] = settings.channels[c] * CHANNEL_SCALE;
+        }
+
+        for (size_t i = 0; i < count; ++i) {
+            float left = 0.0f, right = 0.0f;
+
+            for (size_t c = 0; c < MIXER_CHANNELS; ++c) {
+                left += block.left[c][i] * gains[c];
+                right += block.right[c][i] * gains[c];
+            }
+
+            left *= block.left_master[i];
+            right *= block.right_master[i];
+
+            float filtered_left = left - left_capacitor;
+            left_capacitor = left - filtered_left * charge_factor;
+
+            float filtered_right = right - right_capacitor;
+            right_capacitor = right - filtered_right * charge_factor;
+
+            output[i * 2] = std::clamp(filtered_left * settings.volume, -1.0f, 1.0f);
+            output[i * 2 + 1] = std::clamp(filtered_right * settings.volume, -1.0f, 1.0f);
+        }
+    }
+
+    void AudioMixer::high_pass(size_t count) {
+        // Locals keep the capacitors in registers, the stores below could alias the members
+        float left_cap = left_capacitor, right_cap = right_capacitor;
+        const float charge = charge_factor;
+
+        // Both sides share one loop so their dependency chains overlap
+        for (size_t i = 0; i < count; ++i) {
+            float left = mixed_left[i];
+            float right = mixed_right[i];
+            float filtered_left = left - left_cap;
+            float filtered_right = right - right_cap;
+
+            left_cap = left - filtered_left * charge;
+            right_cap = right - filtered_right * charge;
+
+            mixed_left[i] = filtered_left;
+            mixed_right[i] = filtered_right;
+        }
+
+        left_capacitor = left_cap;
+        right_capacitor = right_cap;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "APU.hpp"
+#include <array>
+#include <cinttypes>
+#include <span>
+#include <vector>
+
+namespace GB {
+    constexpr size_t MIXER_CHANNELS = 4;
+
+    // Gains are sampled once per block so the config is never touched per sample
+    struct MixerSettings {
+        float volume = 1.0f;
+        std::array<float, MIXER_CHANNELS> channels{1.0f, 1.0f, 1.0f, 1.0f};
+    };
+
+    // Structure-of-arrays storage for one block of APU output
+    class SampleBlock {
+    public:
+        size_t size() const;
+        size_t capacity() const;
+        bool full() const;
+
+        void resize(size_t new_capacity);
+        void clear();
+        void push(const SampleResult &result);
+
+        std::array<std::vector<float>, MIXER_CHANNELS> left{};
+        std::array<std::vector<float>, MIXER_CHANNELS> right{};
+        std::vector<float> left_master{};
+        std::vector<float> right_master{};
+
+    private:
+        size_t count = 0;
+    };
+
+    class AudioMixer {
+    public:
+        void reset();
+        void set_sample_rate(int32_t rate);
+
+        // Writes block.size() interleaved stereo frames into output
+        void mix(const SampleBlock &block, const MixerSettings &settings, std::span<float> output);
+        void mix_scalar(const SampleBlock &block, const MixerSettings &settings,
+                        std::span<float> output);
+
+    private:
+        void high_pass(size_t count);
+
+        float charge_factor = 0.996f;
+        float left_capacitor = 0.0f;
+        float right_capacitor = 0.0f;
+
+        std::vector<float> mixed_left{};
+        std::vector<float> mixed_right{};
+    };
+}
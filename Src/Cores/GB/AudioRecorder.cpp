@@ -0,0 +1,161 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "AudioRecorder.hpp"
+
+namespace GB {
+    constexpr std::array<const char *, MIXER_CHANNELS> STEM_NAMES{
+        "pulse1",
+        "pulse2",
+        "wave",
+        "noise",
+    };
+
+    AudioRecorder::AudioRecorder() {
+        for (auto &block : blocks) {
+            block.resize(BLOCK_FRAMES);
+        }
+
+        output.resize(BLOCK_FRAMES * 2);
+    }
+
+    AudioRecorder::~AudioRecorder() { close(); }
+
+    bool AudioRecorder::open(std::filesystem::path path, int32_t sample_rate, bool write_stems) {
+        close();
+
+        if (!file.open(path, 2, sample_rate)) {
+            return false;
+        }
+
+        stems = write_stems;
+        mixer.set_sample_rate(sample_rate);
+        mixer.reset();
+
+        if (stems) {
+            for (size_t c = 0; c < MIXER_CHANNELS; ++c) {
+                auto stem_path = path;
+                stem_path.replace_extension(std::string(STEM_NAMES[c]) +
+                                            path.extension().string());
+
+                if (!stem_files[c].open(stem_path, 2, sample_rate)) {
+                    close();
+                    return false;
+                }
+
+                stem_mixers[c].set_sample_rate(sample_rate);
+                stem_mixers[c].reset();
+            }
+        }
+
+        filling = 0;
+        blocks[filling].clear();
+        pending = nullptr;
+        stopping = false;
+        writer = std::thread(&AudioRecorder::writer_loop, this);
+
+        return true;
+    }
+
+    void AudioRecorder::push(const SampleResult &result) {
+        auto &block = blocks[filling];
+        block.push(result);
+
+        if (block.full()) {
+            submit();
+        }
+    }
+
+    void AudioRecorder::close() {
+        if (writer.joinable()) {
+            if (blocks[filling].size() > 0) {
+                submit();
+            }
+
+            {
+                std::lock_guard lock(mutex);
+                stopping = true;
+            }
+
+            signal.notify_all();
+            writer.join();
+        }
+
+        file.close();
+
+        for (auto &stem_file : stem_files) {
+            stem_file.close();
+        }
+    }
+
+    void AudioRecorder::submit() {
+        {
+            std::unique_lock lock(mutex);
+            signal.wait(lock, [this] { return pending == nullptr; });
+            pending = &blocks[filling];
+        }
+
+        signal.notify_all();
+        filling ^= 1;
+        blocks[filling].clear();
+    }
+
+    void AudioRecorder::writer_loop() {
+        while (true) {
+            SampleBlock *block = nullptr;
+
+            {
+                std::unique_lock lock(mutex);
+                signal.wait(lock, [this] { return pending != nullptr || stopping; });
+
+                if (!pending) {
+                    return;
+                }
+
+                block = pending;
+            }
+
+            write_block(*block);
+
+            {
+                std::lock_guard lock(mutex);
+                pending = nullptr;
+            }
+
+            signal.notify_all();
+        }
+    }
+
+    void AudioRecorder::write_block(const SampleBlock &block) {
+        std::span<float> frames(output.data(), block.size() * 2);
+
+        mixer.mix(block, MixerSettings{}, frames);
+        file.write(frames);
+
+        if (stems) {
+            for (size_t c = 0; c < MIXER_CHANNELS; ++c) {
+                MixerSettings solo{};
+                solo.channels.fill(0.0f);
+                solo.channels[c] = 1.0f;
+
+                stem_mixers[c].mix(block, solo, frames);
+                stem_files[c].write(frames);
+            }
+        }
+    }
+}
@@ -0,0 +1,70 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "AudioMixer.hpp"
+#include "WavWriter.hpp"
+#include <array>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace GB {
+    // Records APU output to WAV files. The core only fills one of two sample blocks, mixing
+    // and disk I/O happen on a writer thread so the core waits only if the writer falls a
+    // full block behind.
+    class AudioRecorder {
+    public:
+        static constexpr size_t BLOCK_FRAMES = 16384;
+
+        AudioRecorder();
+        ~AudioRecorder();
+        AudioRecorder(const AudioRecorder &) = delete;
+        AudioRecorder(AudioRecorder &&other) = delete;
+        AudioRecorder &operator=(const AudioRecorder &) = delete;
+        AudioRecorder &operator=(AudioRecorder &&other) = delete;
+
+        // With stems enabled each channel is also written to <name>.<channel>.wav
+        bool open(std::filesystem::path path, int32_t sample_rate, bool write_stems);
+        void push(const SampleResult &result);
+        void close();
+
+    private:
+        void submit();
+        void writer_loop();
+        void write_block(const SampleBlock &block);
+
+        std::array<SampleBlock, 2> blocks{};
+        size_t filling = 0;
+
+        std::mutex mutex;
+        std::condition_variable signal;
+        SampleBlock *pending = nullptr;
+        bool stopping = false;
+        std::thread writer;
+
+        bool stems = false;
+        AudioMixer mixer{};
+        WavWriter file{};
+        std::array<AudioMixer, MIXER_CHANNELS> stem_mixers{};
+        std::array<WavWriter, MIXER_CHANNELS> stem_files{};
+        std::vector<float> output{};
+    };
+}
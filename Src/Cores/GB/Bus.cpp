@@ -18,6 +18,7 @@
 
 #include "Bus.hpp"
 #include "Core.hpp"
+#include "State.hpp"
 #include <stdexcept>
 
 namespace GB {
@@ -34,11 +35,24 @@ namespace GB {
     void MainBus::reset(Cartridge *new_cart) {
         KEY0 = 0;
         bootstrap_mapped_ = true;
+        serial_data = 0;
+        serial_control = 0;
         wram.fill(0);
         hram.fill(0);
         cart = new_cart;
     }
 
+    void MainBus::set_serial_callback(std::function<void(uint8_t value)> callback) {
+        serial_callback = std::move(callback);
+    }
+
+    std::span<const uint8_t> MainBus::work_ram() const { return wram; }
+
+    void MainBus::serialize(StateArchive &archive) {
+        archive(bootstrap_mapped_, wram_bank_num, KEY0, serial_data, serial_control);
+        archive(wram, hram);
+    }
+
     uint8_t MainBus::read(uint16_t address) {
         auto page = address >> 12;
 
@@ -105,9 +119,11 @@ namespace GB {
                 }
 
                 // Serial Port
-                case 0x01:
+                case 0x01: {
+                    return serial_data;
+                }
                 case 0x02: {
-                    return 0xFF;
+                    return serial_control | 0x7C;
                 }
 
                 // Timer
@@ -177,7 +193,6 @@ namespace GB {
                 case 0x43:
                 case 0x44:
                 case 0x45:
-                case 0x46:
                 case 0x47:
                 case 0x48:
                 case 0x49:
@@ -192,6 +207,9 @@ namespace GB {
                     return core->ppu.read_register(io_address);
                 }
 
+                case 0x46: {
+                    return core->oam_dma.get_source();
+                }
                 case 0x4C: {
                     return KEY0;
                 }
@@ -226,6 +244,39 @@ namespace GB {
         return 0;
     }
 
+    const uint8_t *MainBus::memory_pointer(uint16_t address) const {
+        auto page = address >> 12;
+
+        switch (page) {
+        case 0x0:
+        case 0x1:
+        case 0x2:
+        case 0x3:
+        case 0x4:
+        case 0x5:
+        case 0x6:
+        case 0x7:
+        case 0xA:
+        case 0xB: {
+            if (!cart || (page < 0x8 && bootstrap_mapped_)) {
+                return nullptr;
+            }
+
+            return cart->memory_pointer(address);
+        }
+        case 0xC:
+        case 0xE: {
+            return &wram[address & 0xFFF];
+        }
+        case 0xD: {
+            return &wram[(wram_bank_num * 0x1000) + (address & 0xFFF)];
+        }
+        default: {
+            return nullptr;
+        }
+        }
+    }
+
     void MainBus::write(uint16_t address, uint8_t value) {
         auto page = address >> 12;
 
@@ -302,6 +353,26 @@ namespace GB {
                     return;
                 }
 
+                // Serial Port
+                case 0x01: {
+                    serial_data = value;
+                    return;
+                }
+                case 0x02: {
+                    serial_control = value & 0x83;
+
+                    if ((value & 0x81) == 0x81) {
+                        if (serial_callback) {
+                            serial_callback(serial_data);
+                        }
+
+                        serial_data = 0xFF;
+                        serial_control &= ~0x80;
+                        core->cpu.request_interrupt(INT_SERIAL_PORT_BIT);
+                    }
+                    return;
+                }
+
                 // Timer
                 case 0x04:
                 case 0x05:
@@ -372,7 +443,6 @@ namespace GB {
                 case 0x42:
                 case 0x43:
                 case 0x45:
-                case 0x46:
                 case 0x47:
                 case 0x48:
                 case 0x49:
@@ -388,6 +458,10 @@ namespace GB {
                     return;
                 }
 
+                case 0x46: {
+                    core->oam_dma.start(value);
+                    return;
+                }
                 case 0x4C: {
                     if (bootstrap_mapped_) {
                         KEY0 = value;
@@ -19,10 +19,13 @@
 #pragma once
 #include <array>
 #include <cinttypes>
+#include <functional>
+#include <span>
 
 namespace GB {
     class Cartridge;
     class Core;
+    class StateArchive;
 
     class MainBus {
     public:
@@ -36,14 +39,30 @@ namespace GB {
         uint8_t read(uint16_t address);
         void write(uint16_t address, uint8_t value);
 
+        // Direct view of cartridge or work RAM for bulk copies, valid to the end of the 4 KiB
+        // page. Anything with side effects or a mapping quirk returns nullptr.
+        const uint8_t *memory_pointer(uint16_t address) const;
+
+        // Receives every byte sent over the link port with the internal clock. Nothing is ever
+        // connected, transfers finish at once and read back 0xFF.
+        void set_serial_callback(std::function<void(uint8_t value)> callback);
+
+        // All eight banks of work RAM, a DMG only uses the first two
+        std::span<const uint8_t> work_ram() const;
+
+        void serialize(StateArchive &archive);
+
     private:
         bool bootstrap_mapped_ = true;
         uint8_t wram_bank_num = 1;
         uint8_t KEY0 = 0x0;
+        uint8_t serial_data = 0, serial_control = 0;
 
         std::array<uint8_t, 32768> wram{};
         std::array<uint8_t, 127> hram{};
 
+        std::function<void(uint8_t value)> serial_callback = nullptr;
+
         Cartridge *cart = nullptr;
         Core *core;
 
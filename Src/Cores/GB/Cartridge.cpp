@@ -18,169 +18,410 @@
 
 #include "Cartridge.hpp"
 #include "Constants.hpp"
+#include "SaveWriter.hpp"
+#include "State.hpp"
+#include <algorithm>
+#include <chrono>
 #include <fstream>
+#include <utility>
 
 namespace GB {
-    Cartridge::Cartridge(CartHeader &&header) : header_(std::move(header)) {}
+    constexpr size_t GBS_HEADER_SIZE = 0x70;
+    constexpr uint16_t GBS_DRIVER_ADDRESS = 0x0100;
+    constexpr uint16_t GBS_DRIVER_END = 0x0130;
 
-    const CartHeader &Cartridge::header() const { return header_; }
+    static uint16_t read_u16(const uint8_t *bytes) { return bytes[0] | (bytes[1] << 8); }
 
-    std::unique_ptr<Cartridge> Cartridge::from_file(std::filesystem::path rom_path) {
-        return std::unique_ptr<Cartridge>(from_file_raw_ptr(std::move(rom_path)));
+    // Only hands out a pointer when the whole 4 KiB page around offset is backed by data
+    static const uint8_t *page_pointer(const uint8_t *data, size_t size, size_t offset) {
+        return (offset | 0xFFF) < size ? data + offset : nullptr;
     }
 
-    Cartridge *Cartridge::from_file_raw_ptr(std::filesystem::path rom_path) {
-        if (!std::filesystem::exists(rom_path)) {
-            return nullptr;
+    static size_t ram_bytes(RamSize size) {
+        switch (size) {
+        case RamSize::Ram2KB:
+            return 0x800;
+        case RamSize::Ram8KB:
+            return 0x2000;
+        case RamSize::Ram32KB:
+            return 0x8000;
+        case RamSize::Ram64KB:
+            return 0x10000;
+        case RamSize::Ram128KB:
+            return 0x20000;
+        default:
+            return 0;
         }
+    }
 
-        CartHeader header{};
-        header.file_path = std::move(rom_path);
-        std::ifstream rom(header.file_path, std::ios::binary | std::ios::ate);
-        if (rom) {
+    // Bank bits beyond the size of the chip are not connected, so higher banks mirror lower ones
+    static size_t ram_offset(const std::vector<uint8_t> &ram, size_t offset) {
+        return offset & (ram.size() - 1);
+    }
 
-            size_t rom_len = rom.tellg();
+    static uint64_t unix_time() {
+        auto now = std::chrono::system_clock::now().time_since_epoch();
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(now).count());
+    }
 
-            if (rom_len < 0x14F) {
-                return nullptr;
-            }
+    static bool parse_gbs_header(const uint8_t *bytes, GBSHeader &gbs) {
+        gbs.version = bytes[0x03];
+        gbs.track_count = bytes[0x04];
+        gbs.first_track = bytes[0x05];
+        gbs.load_address = read_u16(&bytes[0x06]);
+        gbs.init_address = read_u16(&bytes[0x08]);
+        gbs.play_address = read_u16(&bytes[0x0A]);
+        gbs.stack_pointer = read_u16(&bytes[0x0C]);
+        gbs.timer_modulo = bytes[0x0E];
+        gbs.timer_control = bytes[0x0F];
+        gbs.title.assign(reinterpret_cast<const char *>(&bytes[0x10]), 32);
+        gbs.author.assign(reinterpret_cast<const char *>(&bytes[0x30]), 32);
+        gbs.copyright.assign(reinterpret_cast<const char *>(&bytes[0x50]), 32);
+
+        return gbs.version == 1 && gbs.track_count != 0 && gbs.load_address >= GBS_DRIVER_END &&
+               gbs.load_address < 0x8000;
+    }
 
-            rom.seekg(0x134);
+    static std::vector<uint8_t> load_battery_file(const std::filesystem::path &path) {
+        std::vector<uint8_t> contents{};
+        std::ifstream sram(path, std::ios::binary | std::ios::ate);
+        if (sram) {
+            contents.resize(sram.tellg());
 
-            header.title.resize(16, '\0');
+            sram.seekg(0);
 
-            rom.read(header.title.data(), static_cast<std::streamsize>(header.title.size()));
+            sram.read(reinterpret_cast<char *>(contents.data()),
+                      static_cast<std::streamsize>(contents.size()));
+            sram.close();
+        }
 
-            rom.seekg(0x143);
+        return contents;
+    }
 
-            rom.read(reinterpret_cast<char *>(&header.cgb_support), 1);
-            rom.read(reinterpret_cast<char *>(&header.license_code), 2);
-            rom.read(reinterpret_cast<char *>(&header.sgb_flag), 1);
-            rom.read(reinterpret_cast<char *>(&header.mbc_type), 1);
-            rom.read(reinterpret_cast<char *>(&header.rom_size), 1);
-            rom.read(reinterpret_cast<char *>(&header.ram_size), 1);
-            rom.read(reinterpret_cast<char *>(&header.region_code), 1);
-            rom.read(reinterpret_cast<char *>(&header.old_license_code), 1);
-            rom.read(reinterpret_cast<char *>(&header.version), 1);
-            rom.read(reinterpret_cast<char *>(&header.header_checksum), 1);
-            rom.read(reinterpret_cast<char *>(&header.checksum), 2);
+    bool parse_cart_header(std::span<const uint8_t> bytes, CartHeader &header) {
+        if (bytes.size() > GBS_HEADER_SIZE && std::equal(bytes.begin(), bytes.begin() + 3, "GBS")) {
+            GBSHeader gbs{};
 
-            Cartridge *mbc = nullptr;
-            switch (header.mbc_type) {
-            case 0x00: // ROM ONLY
-            {
-                mbc = new ROM(std::move(header));
-                break;
-            }
-            case 0x01: // MBC1
-            case 0x02: // MBC1+RAM
-            case 0x03: // MBC1+RAM+BATTERY
-            {
-                mbc = new MBC1(std::move(header));
-                break;
-            }
-            case 0x05: // MBC2
-            case 0x06: // MBC2+BATTERY
-            {
-                mbc = new MBC2(std::move(header));
-                break;
+            if (!parse_gbs_header(bytes.data(), gbs)) {
+                return false;
             }
 
-            case 0x0F: // MBC3+TIMER+BATTERY
-            case 0x10: // MBC3+TIMER+RAM+BATTERY
-            case 0x11: // MBC3
-            case 0x12: // MBC3+RAM
-            case 0x13: // MBC3+RAM+BATTERY
-            {
-                mbc = new MBC3(std::move(header));
-                break;
-            }
+            header.title = gbs.title;
+            header.is_gbs = true;
 
-            case 0x19: // MBC5
-            case 0x1A: // MBC5+RAM
-            case 0x1B: // MBC5+RAM+BATTERY
-            case 0x1C: // MBC5+RUMBLE
-            case 0x1D: // MBC5+RUMBLE+RAM
-            case 0x1E: // MBC5+RUMBLE+RAM+BATTERY
-            {
-                mbc = new MBC5(std::move(header));
-                break;
-            }
+            // The double speed flag needs CGB mode for the KEY1 switch to work
+            if (gbs.timer_control & 0x80) {
+                header.cgb_support = 0x80;
             }
 
-            if (mbc) {
-                mbc->init_banks(rom);
-                mbc->load_sram_from_file();
-                rom.close();
-                return mbc;
-            }
+            return true;
+        }
+
+        if (bytes.size() < CART_HEADER_END) {
+            return false;
+        }
+
+        header.title.assign(reinterpret_cast<const char *>(&bytes[0x134]), 16);
+        header.cgb_support = bytes[0x143];
+        header.license_code = read_u16(&bytes[0x144]);
+        header.sgb_flag = bytes[0x146];
+        header.mbc_type = bytes[0x147];
+        header.rom_size = static_cast<RomSize>(bytes[0x148]);
+        header.ram_size = static_cast<RamSize>(bytes[0x149]);
+        header.region_code = bytes[0x14A];
+        header.old_license_code = bytes[0x14B];
+        header.version = bytes[0x14C];
+        header.header_checksum = bytes[0x14D];
+        header.checksum = read_u16(&bytes[0x14E]);
+        header.is_gbs = false;
+
+        return true;
+    }
+
+    void Cartridge::attach_rom() {
+        if (auto player = std::get_if<GBSMapper>(&mapper)) {
+            rom = player->program_bytes();
+        } else {
+            rom = image->bytes();
+        }
+
+        update_banks();
+    }
+
+    void Cartridge::update_banks() {
+        auto banks =
+            std::visit([this](const auto &m) { return m.rom_banks(rom.size() / 0x4000); }, mapper);
+
+        rom_banks[0] = rom.data() + (banks[0] * 0x4000);
+        rom_banks[1] = rom.data() + (banks[1] * 0x4000);
+    }
+
+    const CartHeader &Cartridge::header() const { return header_; }
+
+    bool Cartridge::has_battery() const {
+        return std::visit([](const auto &m) { return m.has_battery(); }, mapper);
+    }
+
+    GBSMapper *Cartridge::gbs() { return std::get_if<GBSMapper>(&mapper); }
+
+    void Cartridge::reset() {
+        std::visit([](auto &m) { m.reset(); }, mapper);
+        update_banks();
+    }
+
+    void Cartridge::write(uint16_t address, uint8_t value) {
+        std::visit([address, value](auto &m) { m.write(address, value); }, mapper);
+        update_banks();
+    }
+
+    uint8_t Cartridge::read_ram(uint16_t address) {
+        return std::visit([address](auto &m) { return m.read_ram(address); }, mapper);
+    }
+
+    void Cartridge::write_ram(uint16_t address, uint8_t value) {
+        std::visit([address, value](auto &m) { m.write_ram(address, value); }, mapper);
+    }
+
+    const uint8_t *Cartridge::memory_pointer(uint16_t address) const {
+        if (address < 0x8000) {
+            return rom_banks[address >> 14] + (address & 0x3FFF);
+        }
+
+        if (address >= 0xA000 && address < 0xC000) {
+            return std::visit([address](const auto &m) { return m.ram_pointer(address & 0x1FFF); },
+                              mapper);
         }
 
         return nullptr;
     }
 
-    ROM::ROM(CartHeader &&header) : Cartridge(std::move(header)), rom() {}
+    void Cartridge::save_sram_to_file() {
+        if (!has_battery() || header_.file_path.empty()) {
+            return;
+        }
 
-    void ROM::reset() {}
+        // A private image leaves the dirty pages for the save writer
+        std::vector<uint8_t> image{};
+        auto ram = std::visit([](auto &m) { return m.battery_ram(); }, mapper);
+        image.assign(ram.begin(), ram.end());
+
+        auto mbc3 = std::get_if<MBC3>(&mapper);
+        if (mbc3 && mbc3->has_rtc()) {
+            auto footer = mbc3->save_rtc();
+            image.insert(image.end(), footer.begin(), footer.end());
+        }
+
+        write_save_file(save_path(), image);
+    }
+
+    void Cartridge::load_sram_from_file() {
+        if (!has_battery()) {
+            return;
+        }
+
+        auto ram = std::visit([](auto &m) { return m.battery_ram(); }, mapper);
+        auto contents = load_battery_file(save_path());
+        std::span<const uint8_t> data = contents;
+        auto mbc3 = std::get_if<MBC3>(&mapper);
 
-    void ROM::init_banks(std::ifstream &rom_stream) {
-        rom_stream.seekg(0, std::ios::end);
+        // RAM sizes are multiples of 2 KiB, anything past that is the 48 or 44 byte RTC block
+        size_t footer_size = data.size() % 0x800;
 
-        rom.resize(rom_stream.tellg());
+        if (mbc3 && mbc3->has_rtc() && (footer_size == RTC_FOOTER_SIZE || footer_size == 44)) {
+            mbc3->load_rtc(data.last(footer_size));
+            data = data.first(data.size() - footer_size);
+        }
 
-        rom_stream.seekg(0);
-        rom_stream.read(reinterpret_cast<char *>(rom.data()),
-                        static_cast<std::streamsize>(rom.size()));
+        std::copy_n(data.begin(), std::min(data.size(), ram.size()), ram.begin());
     }
 
-    uint8_t ROM::read(uint16_t address) { return rom[address]; }
+    bool Cartridge::update_save_image(std::vector<uint8_t> &image, bool force) {
+        if (!has_battery()) {
+            return false;
+        }
 
-    void ROM::write(uint16_t address, uint8_t value) {}
+        auto ram = std::visit([](auto &m) { return m.battery_ram(); }, mapper);
+        uint64_t dirty = std::visit([](auto &m) { return m.take_dirty_pages(); }, mapper);
+        auto mbc3 = std::get_if<MBC3>(&mapper);
+        bool rtc = mbc3 && mbc3->has_rtc();
 
-    uint8_t ROM::read_ram(uint16_t address) { return 0xFF; }
+        size_t image_size = ram.size() + (rtc ? RTC_FOOTER_SIZE : 0);
+        if (image.size() != image_size) {
+            image.assign(image_size, 0);
+            dirty = ~0ull;
+        }
 
-    void ROM::write_ram(uint16_t address, uint8_t value) {}
+        if (!dirty && !force) {
+            return false;
+        }
 
-    void ROM::save_sram_to_file() {}
+        for (size_t page = 0; page * SAVE_PAGE_SIZE < ram.size(); ++page) {
+            if (dirty & (1ull << page)) {
+                size_t offset = page * SAVE_PAGE_SIZE;
+                size_t length = std::min(SAVE_PAGE_SIZE, ram.size() - offset);
+                std::copy_n(ram.begin() + offset, length, image.begin() + offset);
+            }
+        }
 
-    void ROM::load_sram_from_file() {}
+        if (rtc) {
+            auto footer = mbc3->save_rtc();
+            std::copy(footer.begin(), footer.end(), image.begin() + ram.size());
+        }
 
-    void ROM::tick(int32_t cycles) {}
+        return true;
+    }
 
-    MBC1::MBC1(CartHeader &&header) : Cartridge(std::move(header)), eram() { eram.fill(0); }
+    std::filesystem::path Cartridge::save_path() const {
+        std::filesystem::path path = header_.file_path;
+        path += ".sram";
+        return path;
+    }
 
-    bool MBC1::has_battery() const { return header_.mbc_type == 3; }
+    size_t Cartridge::resident_bytes() const {
+        return sizeof(Cartridge) +
+               std::visit([](const auto &m) { return m.allocated_bytes(); }, mapper);
+    }
 
-    void MBC1::reset() {
-        mode = 0;
-        rom_bank_num = 1;
-        bank_upper_bits = 0;
-        ram_enabled = false;
-        eram.fill(0);
+    void Cartridge::attach_clock(const uint64_t *clock) {
+        if (auto mbc3 = std::get_if<MBC3>(&mapper)) {
+            mbc3->attach_clock(clock);
+        }
     }
 
-    void MBC1::init_banks(std::ifstream &rom_stream) {
-        rom_stream.seekg(0, std::ios::end);
-        auto rom_len = rom_stream.tellg();
-        rom_stream.seekg(0);
+    void Cartridge::serialize(StateArchive &archive) {
+        std::visit([&archive](auto &m) { m.serialize(archive); }, mapper);
 
-        rom.resize(rom_len);
+        if (archive.loading()) {
+            update_banks();
+        }
+    }
 
-        rom_stream.read(reinterpret_cast<char *>(rom.data()), rom_len);
+    std::unique_ptr<Cartridge> Cartridge::from_file(std::filesystem::path rom_path) {
+        return std::unique_ptr<Cartridge>(from_file_raw_ptr(std::move(rom_path)));
     }
 
-    uint8_t MBC1::read(uint16_t address) {
-        int32_t bank_num = (bank_upper_bits << 5);
+    Cartridge *Cartridge::from_file_raw_ptr(std::filesystem::path rom_path) {
+        auto image = RomImage::open(rom_path);
 
-        if (address < 0x4000) {
-            bank_num = bank_num % static_cast<int32_t>(rom.size() / 0x4000);
-            return rom[(mode ? (bank_num * 0x4000) : 0) + address];
+        if (!image) {
+            return nullptr;
         }
 
-        bank_num |= rom_bank_num;
-        bank_num = bank_num % static_cast<int32_t>(rom.size() / 0x4000);
+        return from_image(std::move(image), std::move(rom_path));
+    }
 
-        return rom[(bank_num * 0x4000) + (address & 0x3FFF)];
+    std::unique_ptr<Cartridge> Cartridge::from_memory(std::span<const uint8_t> rom) {
+        auto image = RomImage::from_memory(rom);
+
+        if (!image) {
+            return nullptr;
+        }
+
+        return std::unique_ptr<Cartridge>(from_image(std::move(image), {}));
+    }
+
+    std::unique_ptr<Cartridge> Cartridge::share_image() const {
+        return std::unique_ptr<Cartridge>(from_image(image, {}));
+    }
+
+    Cartridge *Cartridge::from_image(std::shared_ptr<const RomImage> image,
+                                     std::filesystem::path rom_path) {
+        CartHeader header{};
+        header.file_path = std::move(rom_path);
+        auto bytes = image->bytes().first(image->file_length());
+
+        if (!parse_cart_header(bytes, header)) {
+            return nullptr;
+        }
+
+        if (header.is_gbs) {
+            GBSHeader gbs{};
+            parse_gbs_header(bytes.data(), gbs);
+
+            const RomImage &file = *image;
+            return new Cartridge(std::move(header), std::move(image),
+                                 std::in_place_type<GBSMapper>, std::move(gbs), file);
+        }
+
+        Cartridge *mbc = nullptr;
+        switch (header.mbc_type) {
+        case 0x00: // ROM ONLY
+        {
+            mbc = new Cartridge(std::move(header), std::move(image), std::in_place_type<ROM>);
+            break;
+        }
+        case 0x01: // MBC1
+        case 0x02: // MBC1+RAM
+        case 0x03: // MBC1+RAM+BATTERY
+        {
+            mbc = new Cartridge(std::move(header), std::move(image), std::in_place_type<MBC1>);
+            break;
+        }
+        case 0x05: // MBC2
+        case 0x06: // MBC2+BATTERY
+        {
+            mbc = new Cartridge(std::move(header), std::move(image), std::in_place_type<MBC2>);
+            break;
+        }
+
+        case 0x0F: // MBC3+TIMER+BATTERY
+        case 0x10: // MBC3+TIMER+RAM+BATTERY
+        case 0x11: // MBC3
+        case 0x12: // MBC3+RAM
+        case 0x13: // MBC3+RAM+BATTERY
+        {
+            mbc = new Cartridge(std::move(header), std::move(image), std::in_place_type<MBC3>);
+            break;
+        }
+
+        case 0x19: // MBC5
+        case 0x1A: // MBC5+RAM
+        case 0x1B: // MBC5+RAM+BATTERY
+        case 0x1C: // MBC5+RUMBLE
+        case 0x1D: // MBC5+RUMBLE+RAM
+        case 0x1E: // MBC5+RUMBLE+RAM+BATTERY
+        {
+            mbc = new Cartridge(std::move(header), std::move(image), std::in_place_type<MBC5>);
+            break;
+        }
+        }
+
+        if (mbc && !mbc->header_.file_path.empty()) {
+            mbc->load_sram_from_file();
+        }
+
+        return mbc;
+    }
+
+    ROM::ROM(const CartHeader &header) {}
+
+    void ROM::reset() {}
+
+    void ROM::write(uint16_t address, uint8_t value) {}
+
+    uint8_t ROM::read_ram(uint16_t address) { return 0xFF; }
+
+    void ROM::write_ram(uint16_t address, uint8_t value) {}
+
+    std::array<size_t, 2> ROM::rom_banks(size_t bank_count) const { return {0, 1}; }
+
+    const uint8_t *ROM::ram_pointer(uint16_t address) const { return nullptr; }
+
+    std::span<uint8_t> ROM::battery_ram() { return {}; }
+
+    uint64_t ROM::take_dirty_pages() { return 0; }
+
+    void ROM::serialize(StateArchive &archive) {}
+
+    MBC1::MBC1(const CartHeader &header)
+        : battery(header.mbc_type == 3), large_rom(header.rom_size >= RomSize::Rom1MB),
+          large_ram(header.ram_size == RamSize::Ram32KB), eram(ram_bytes(header.ram_size)) {}
+
+    void MBC1::reset() {
+        mode = 0;
+        rom_bank_num = 1;
+        bank_upper_bits = 0;
+        ram_enabled = false;
     }
 
     void MBC1::write(uint16_t address, uint8_t value) {
@@ -202,12 +443,12 @@ namespace GB {
         case 0x4:
         case 0x5: {
             if (mode) {
-                if (header_.ram_size == RamSize::Ram32KB) {
+                if (large_ram) {
                     bank_upper_bits = value & 0x3;
                 }
             }
 
-            if (header_.rom_size >= RomSize::Rom1MB) {
+            if (large_rom) {
                 bank_upper_bits = (value & 0x3);
             }
             break;
@@ -222,84 +463,51 @@ namespace GB {
     }
 
     uint8_t MBC1::read_ram(uint16_t address) {
-        if (ram_enabled) {
-            return eram[(mode ? (bank_upper_bits * 0x2000) : 0) + address];
+        if (ram_enabled && !eram.empty()) {
+            return eram[ram_offset(eram, (mode ? (bank_upper_bits * 0x2000) : 0) + address)];
         }
 
         return 0xFF;
     }
 
     void MBC1::write_ram(uint16_t address, uint8_t value) {
-        if (ram_enabled) {
-            eram[(mode ? (bank_upper_bits * 0x2000) : 0) + address] = value;
+        if (ram_enabled && !eram.empty()) {
+            size_t offset = ram_offset(eram, (mode ? (bank_upper_bits * 0x2000) : 0) + address);
+            eram[offset] = value;
+            dirty_pages |= 1ull << (offset / SAVE_PAGE_SIZE);
         }
     }
 
-    void MBC1::save_sram_to_file() {
-        if (!has_battery()) {
-            return;
-        }
-
-        std::filesystem::path path = header_.file_path;
-        path += ".sram";
+    std::array<size_t, 2> MBC1::rom_banks(size_t bank_count) const {
+        size_t upper = static_cast<size_t>(bank_upper_bits) << 5;
+        size_t low_bank = mode ? (upper % bank_count) : 0;
 
-        std::ofstream sram(path, std::ios::binary);
-        if (sram) {
-            sram.write(reinterpret_cast<char *>(eram.data()),
-                       static_cast<std::streamsize>(eram.size()));
-            sram.close();
-        }
+        return {low_bank, (upper | rom_bank_num) % bank_count};
     }
 
-    void MBC1::load_sram_from_file() {
-        if (!has_battery()) {
-            return;
+    const uint8_t *MBC1::ram_pointer(uint16_t address) const {
+        if (!ram_enabled || eram.empty()) {
+            return nullptr;
         }
 
-        std::filesystem::path path = header_.file_path;
-        path += ".sram";
+        size_t offset = ram_offset(eram, (mode ? (bank_upper_bits * 0x2000) : 0) + address);
+        return page_pointer(eram.data(), eram.size(), offset);
+    }
 
-        std::ifstream sram(path, std::ios::binary | std::ios::ate);
-        if (sram) {
-            auto len = sram.tellg();
+    std::span<uint8_t> MBC1::battery_ram() { return eram; }
 
-            sram.seekg(0);
+    uint64_t MBC1::take_dirty_pages() { return std::exchange(dirty_pages, 0); }
 
-            sram.read(reinterpret_cast<char *>(eram.data()), len);
-            sram.close();
-        }
+    void MBC1::serialize(StateArchive &archive) {
+        archive(mode, rom_bank_num, bank_upper_bits, ram_enabled);
+        dirty_pages |= archive.pages(eram, SAVE_PAGE_SIZE);
     }
 
-    void MBC1::tick(int32_t cycles) {}
-
-    MBC2::MBC2(CartHeader &&header) : Cartridge(std::move(header)) {}
-
-    bool MBC2::has_battery() const { return header_.mbc_type == 6; }
+    MBC2::MBC2(const CartHeader &header) : battery(header.mbc_type == 6) {}
 
     void MBC2::reset() {
         rom_bank_num = 1;
         ram_enabled = false;
-        ram.fill(0);
-    }
-
-    void MBC2::init_banks(std::ifstream &rom_stream) {
-        rom_stream.seekg(0, std::ios::end);
-        auto rom_len = rom_stream.tellg();
-        rom_stream.seekg(0);
-
-        rom.resize(rom_len);
-
-        rom_stream.read(reinterpret_cast<char *>(rom.data()), rom_len);
-    }
-
-    uint8_t MBC2::read(uint16_t address) {
-        if (address < 0x4000) {
-            return rom[address];
-        }
-
-        auto bank = rom_bank_num % (rom.size() / 0x4000);
-
-        return rom[(bank * 0x4000) + (address & 0x3FFF)];
     }
 
     void MBC2::write(uint16_t address, uint8_t value) {
@@ -329,46 +537,26 @@ namespace GB {
     void MBC2::write_ram(uint16_t address, uint8_t value) {
         if (ram_enabled) {
             ram[address & 0x01FF] = value & 0xF;
+            dirty_pages = 1;
         }
     }
 
-    void MBC2::save_sram_to_file() {
-        if (!has_battery()) {
-            return;
-        }
-
-        std::filesystem::path path = header_.file_path;
-        path += ".sram";
-
-        std::ofstream sram(path, std::ios::binary);
-        if (sram) {
-            sram.write(reinterpret_cast<char *>(ram.data()),
-                       static_cast<std::streamsize>(ram.size()));
-            sram.close();
-        }
+    std::array<size_t, 2> MBC2::rom_banks(size_t bank_count) const {
+        return {0, rom_bank_num % bank_count};
     }
 
-    void MBC2::load_sram_from_file() {
-        if (!has_battery()) {
-            return;
-        }
+    // The built-in RAM is 4 bits wide and mirrored, it always goes through read_ram
+    const uint8_t *MBC2::ram_pointer(uint16_t address) const { return nullptr; }
 
-        std::filesystem::path path = header_.file_path;
-        path += ".sram";
+    std::span<uint8_t> MBC2::battery_ram() { return ram; }
 
-        std::ifstream sram(path, std::ios::binary | std::ios::ate);
-        if (sram) {
-            auto len = sram.tellg();
-
-            sram.seekg(0);
+    uint64_t MBC2::take_dirty_pages() { return std::exchange(dirty_pages, 0); }
 
-            sram.read(reinterpret_cast<char *>(ram.data()), len);
-            sram.close();
-        }
+    void MBC2::serialize(StateArchive &archive) {
+        archive(rom_bank_num, ram_enabled);
+        dirty_pages |= archive.pages(ram, SAVE_PAGE_SIZE);
     }
 
-    void MBC2::tick(int32_t cycles) {}
-
     RTCCounter::RTCCounter(uint8_t bit_mask) : mask(bit_mask) {}
 
     uint8_t RTCCounter::get() const { return counter; }
@@ -383,58 +571,29 @@ namespace GB {
         counter &= mask;
     }
 
-    MBC3::MBC3(CartHeader &&header) : Cartridge(std::move(header)) {}
-
-    bool MBC3::has_rtc() const {
-        switch (header_.mbc_type) {
+    MBC3::MBC3(const CartHeader &header) : eram(ram_bytes(header.ram_size)) {
+        switch (header.mbc_type) {
         case 0x0F:   // MBC3+TIMER+BATTERY
         case 0x10: { // MBC3+TIMER+RAM+BATTERY
-            return true;
-        }
+            battery = true;
+            rtc_present = true;
+            break;
         }
-
-        return false;
-    }
-
-    bool MBC3::has_battery() const {
-        switch (header_.mbc_type) {
-        case 0x0F:   // MBC3+TIMER+BATTERY
-        case 0x10:   // MBC3+TIMER+RAM+BATTERY
         case 0x13: { // MBC3+RAM+BATTERY
-            return true;
+            battery = true;
+            break;
         }
         }
-        return false;
     }
 
     void MBC3::reset() {
         rom_bank_num = 1;
         ram_rtc_select = 0;
         ram_rtc_enabled = false;
-        eram.fill(0);
         latch_byte = 0;
-        rtc_cycles = 0;
-        rtc = RTCTimePoint{};
-        shadow_rtc = RTCTimePoint{};
-        rtc_ctrl = 0;
-    }
-
-    void MBC3::init_banks(std::ifstream &rom_stream) {
-        rom_stream.seekg(0, std::ios::end);
-        auto rom_len = rom_stream.tellg();
-        rom_stream.seekg(0);
 
-        rom.resize(rom_len);
-
-        rom_stream.read(reinterpret_cast<char *>(rom.data()), rom_len);
-    }
-
-    uint8_t MBC3::read(uint16_t address) {
-        if (address < 0x4000) {
-            return rom[address];
-        }
-
-        return rom[(rom_bank_num * 0x4000) + (address & 0x3FFF)];
+        // The clock keeps running across resets, like the battery-backed chip does
+        sync_rtc();
     }
 
     void MBC3::write(uint16_t address, uint8_t value) {
@@ -462,6 +621,7 @@ namespace GB {
         case 0x6:
         case 0x7: {
             if ((latch_byte == 0) && (value == 1)) {
+                sync_rtc();
                 shadow_rtc = rtc;
             }
 
@@ -482,8 +642,8 @@ namespace GB {
         case 0x5:
         case 0x6:
         case 0x7: {
-            if (ram_rtc_enabled) {
-                return eram[(ram_rtc_select * 0x2000) + address];
+            if (ram_rtc_enabled && !eram.empty()) {
+                return eram[ram_offset(eram, (ram_rtc_select * 0x2000) + address)];
             }
 
             break;
@@ -510,6 +670,10 @@ namespace GB {
     }
 
     void MBC3::write_ram(uint16_t address, uint8_t value) {
+        if (ram_rtc_select >= 0x8) {
+            sync_rtc();
+        }
+
         switch (ram_rtc_select) {
         case 0x0:
         case 0x1:
@@ -519,8 +683,10 @@ namespace GB {
         case 0x5:
         case 0x6:
         case 0x7: {
-            if (ram_rtc_enabled) {
-                eram[(ram_rtc_select * 0x2000) + address] = value;
+            if (ram_rtc_enabled && !eram.empty()) {
+                size_t offset = ram_offset(eram, (ram_rtc_select * 0x2000) + address);
+                eram[offset] = value;
+                dirty_pages |= 1ull << (offset / SAVE_PAGE_SIZE);
             }
             break;
         }
@@ -552,113 +718,169 @@ namespace GB {
         }
     }
 
-    void MBC3::save_sram_to_file() {
-        if (!has_battery()) {
+    void MBC3::attach_clock(const uint64_t *source) {
+        sync_rtc();
+        clock = source;
+        rtc_base = clock ? *clock : 0;
+    }
+
+    void MBC3::sync_rtc() {
+        uint64_t now = clock ? *clock : rtc_base;
+        uint64_t elapsed = (now - rtc_base) + rtc_cycles;
+        rtc_base = now;
+
+        if (!rtc_present || (rtc_ctrl & 64)) {
             return;
         }
 
-        std::filesystem::path path = header_.file_path;
-        path += ".sram";
+        advance_rtc(elapsed / CPU_CLOCK_RATE);
+        rtc_cycles = static_cast<int32_t>(elapsed % CPU_CLOCK_RATE);
+    }
 
-        std::ofstream sram(path, std::ios::binary);
-        if (sram) {
-            sram.write(reinterpret_cast<char *>(eram.data()),
-                       static_cast<std::streamsize>(eram.size()));
-            sram.close();
+    void MBC3::advance_rtc(uint64_t seconds) {
+        // Values the game wrote past the normal range count up to the register mask before
+        // wrapping without a carry, those are stepped one second at a time
+        while (seconds > 0 &&
+               (rtc.seconds.get() >= 60 || rtc.minutes.get() >= 60 || rtc.hours.get() >= 24)) {
+            increment_rtc_second();
+            seconds--;
         }
-    }
 
-    void MBC3::load_sram_from_file() {
-        if (!has_battery()) {
+        if (seconds == 0) {
             return;
         }
 
-        std::filesystem::path path = header_.file_path;
-        path += ".sram";
+        uint64_t time_of_day =
+            rtc.seconds.get() + (rtc.minutes.get() * 60) + (rtc.hours.get() * 3600) + seconds;
+        uint64_t days = rtc.days + (time_of_day / 86400);
+        time_of_day %= 86400;
 
-        std::ifstream sram(path, std::ios::binary | std::ios::ate);
-        if (sram) {
-            auto len = sram.tellg();
+        rtc.seconds.set(static_cast<uint8_t>(time_of_day % 60));
+        rtc.minutes.set(static_cast<uint8_t>((time_of_day / 60) % 60));
+        rtc.hours.set(static_cast<uint8_t>(time_of_day / 3600));
 
-            sram.seekg(0);
-
-            sram.read(reinterpret_cast<char *>(eram.data()), len);
-            sram.close();
+        if (days >= 512) {
+            days %= 512;
+            rtc_ctrl |= 128;
         }
-    }
 
-    void MBC3::tick(int32_t cycles) {
-        if (has_rtc() && !(rtc_ctrl & 64)) {
-            rtc_cycles += cycles;
+        rtc.days = static_cast<uint16_t>(days);
+    }
 
-            if (rtc_cycles == CPU_CLOCK_RATE) {
-                rtc_cycles = 0;
-                rtc.seconds.increment();
+    void MBC3::increment_rtc_second() {
+        rtc.seconds.increment();
 
-                if (rtc.seconds.get() == 60) {
-                    rtc.seconds.set(0);
-                    rtc.minutes.increment();
+        if (rtc.seconds.get() == 60) {
+            rtc.seconds.set(0);
+            rtc.minutes.increment();
 
-                    if (rtc.minutes.get() == 60) {
-                        rtc.minutes.set(0);
-                        rtc.hours.increment();
+            if (rtc.minutes.get() == 60) {
+                rtc.minutes.set(0);
+                rtc.hours.increment();
 
-                        if (rtc.hours.get() == 24) {
-                            rtc.hours.set(0);
-                            rtc.days++;
+                if (rtc.hours.get() == 24) {
+                    rtc.hours.set(0);
+                    rtc.days++;
 
-                            if (rtc.days == 512) {
-                                rtc.days = 0;
-                                rtc_ctrl |= 128;
-                            }
-                        }
+                    if (rtc.days == 512) {
+                        rtc.days = 0;
+                        rtc_ctrl |= 128;
                     }
                 }
             }
         }
     }
 
-    MBC5::MBC5(CartHeader &&header) : Cartridge(std::move(header)) {}
+    std::array<uint8_t, RTC_FOOTER_SIZE> MBC3::save_rtc() {
+        sync_rtc();
 
-    bool MBC5::has_battery() const {
-        switch (header_.mbc_type) {
-        case 0x1B:   // MBC5+RAM+BATTERY
-        case 0x1E: { // MBC5+RUMBLE+RAM+BATTERY
-            return true;
-        }
-        }
-
-        return false;
+        std::array<uint8_t, RTC_FOOTER_SIZE> footer{};
+        auto put = [&footer](size_t offset, uint64_t value, size_t width) {
+            for (size_t i = 0; i < width; ++i) {
+                footer[offset + i] = static_cast<uint8_t>(value >> (i * 8));
+            }
+        };
+        auto put_time = [&](size_t offset, const RTCTimePoint &time) {
+            put(offset, time.seconds.get(), 4);
+            put(offset + 4, time.minutes.get(), 4);
+            put(offset + 8, time.hours.get(), 4);
+            put(offset + 12, time.days & 0xFF, 4);
+            put(offset + 16, rtc_ctrl | ((time.days >> 8) & 0x1), 4);
+        };
+
+        put_time(0, rtc);
+        put_time(20, shadow_rtc);
+        put(40, unix_time(), 8);
+
+        return footer;
     }
 
-    void MBC5::reset() {
-        rom_bank_num = 1;
-        bank_upper_bits = 0;
-        ram_bank_num = 0;
-        ram_enabled = false;
-        eram.fill(0);
+    void MBC3::load_rtc(std::span<const uint8_t> footer) {
+        auto get = [&footer](size_t offset, size_t width) {
+            uint64_t value = 0;
+            for (size_t i = 0; i < width; ++i) {
+                value |= static_cast<uint64_t>(footer[offset + i]) << (i * 8);
+            }
+            return value;
+        };
+        auto get_time = [&](size_t offset, RTCTimePoint &time) {
+            time.seconds.set(static_cast<uint8_t>(get(offset, 4)));
+            time.minutes.set(static_cast<uint8_t>(get(offset + 4, 4)));
+            time.hours.set(static_cast<uint8_t>(get(offset + 8, 4)));
+            time.days = static_cast<uint16_t>((get(offset + 12, 4) & 0xFF) |
+                                              ((get(offset + 16, 4) & 0x1) << 8));
+        };
+
+        get_time(0, rtc);
+        get_time(20, shadow_rtc);
+        rtc_ctrl = get(16, 4) & 0xC0;
+
+        // Older files store a 32-bit timestamp
+        uint64_t saved_at = get(40, footer.size() - 40);
+        uint64_t now = unix_time();
+
+        rtc_cycles = 0;
+        rtc_base = clock ? *clock : 0;
+
+        // Catch up with the time the host spent without the game running
+        if (!(rtc_ctrl & 64) && now > saved_at) {
+            advance_rtc(now - saved_at);
+        }
     }
 
-    void MBC5::init_banks(std::ifstream &rom_stream) {
-        rom_stream.seekg(0, std::ios::end);
-        auto rom_len = rom_stream.tellg();
-        rom_stream.seekg(0);
+    std::array<size_t, 2> MBC3::rom_banks(size_t bank_count) const {
+        return {0, rom_bank_num % bank_count};
+    }
 
-        rom.resize(rom_len);
+    const uint8_t *MBC3::ram_pointer(uint16_t address) const {
+        // RTC registers share the window with RAM and are never plain memory
+        if (!ram_rtc_enabled || ram_rtc_select >= 0x8 || eram.empty()) {
+            return nullptr;
+        }
 
-        rom_stream.read(reinterpret_cast<char *>(rom.data()), rom_len);
+        size_t offset = ram_offset(eram, (ram_rtc_select * 0x2000) + address);
+        return page_pointer(eram.data(), eram.size(), offset);
     }
 
-    uint8_t MBC5::read(uint16_t address) {
-        int32_t bank_num = rom_bank_num | bank_upper_bits;
+    std::span<uint8_t> MBC3::battery_ram() { return eram; }
 
-        if (address < 0x4000) {
-            return rom[address];
-        }
+    uint64_t MBC3::take_dirty_pages() { return std::exchange(dirty_pages, 0); }
+
+    void MBC3::serialize(StateArchive &archive) {
+        archive(rom_bank_num, ram_rtc_select, ram_rtc_enabled);
+        dirty_pages |= archive.pages(eram, SAVE_PAGE_SIZE);
+        archive(latch_byte, rtc_base, rtc_cycles, rtc, shadow_rtc, rtc_ctrl);
+    }
 
-        bank_num = bank_num % static_cast<int32_t>(rom.size() / 0x4000);
+    MBC5::MBC5(const CartHeader &header)
+        : battery(header.mbc_type == 0x1B || header.mbc_type == 0x1E),
+          eram(ram_bytes(header.ram_size)) {}
 
-        return rom[(bank_num * 0x4000) + (address & 0x3FFF)];
+    void MBC5::reset() {
+        rom_bank_num = 1;
+        bank_upper_bits = 0;
+        ram_bank_num = 0;
+        ram_enabled = false;
     }
 
     void MBC5::write(uint16_t address, uint8_t value) {
@@ -686,53 +908,163 @@ namespace GB {
     }
 
     uint8_t MBC5::read_ram(uint16_t address) {
-        if (ram_enabled) {
-            return eram[(ram_bank_num * 0x2000) + address];
+        if (ram_enabled && !eram.empty()) {
+            return eram[ram_offset(eram, (ram_bank_num * 0x2000) + address)];
         }
 
         return 0xFF;
     }
 
     void MBC5::write_ram(uint16_t address, uint8_t value) {
-        if (ram_enabled) {
-            eram[(ram_bank_num * 0x2000) + address] = value;
+        if (ram_enabled && !eram.empty()) {
+            size_t offset = ram_offset(eram, (ram_bank_num * 0x2000) + address);
+            eram[offset] = value;
+            dirty_pages |= 1ull << (offset / SAVE_PAGE_SIZE);
         }
     }
 
-    void MBC5::save_sram_to_file() {
-        if (!has_battery()) {
-            return;
+    std::array<size_t, 2> MBC5::rom_banks(size_t bank_count) const {
+        return {0, (rom_bank_num | bank_upper_bits) % bank_count};
+    }
+
+    const uint8_t *MBC5::ram_pointer(uint16_t address) const {
+        if (!ram_enabled || eram.empty()) {
+            return nullptr;
         }
 
-        std::filesystem::path path = header_.file_path;
-        path += ".sram";
+        size_t offset = ram_offset(eram, (ram_bank_num * 0x2000) + address);
+        return page_pointer(eram.data(), eram.size(), offset);
+    }
 
-        std::ofstream sram(path, std::ios::binary);
-        if (sram) {
-            sram.write(reinterpret_cast<char *>(eram.data()),
-                       static_cast<std::streamsize>(eram.size()));
-            sram.close();
+    std::span<uint8_t> MBC5::battery_ram() { return eram; }
+
+    uint64_t MBC5::take_dirty_pages() { return std::exchange(dirty_pages, 0); }
+
+    void MBC5::serialize(StateArchive &archive) {
+        archive(rom_bank_num, bank_upper_bits, ram_bank_num, ram_enabled);
+        dirty_pages |= archive.pages(eram, SAVE_PAGE_SIZE);
+    }
+
+    GBSMapper::GBSMapper(const CartHeader &header, GBSHeader &&gbs, const RomImage &image)
+        : gbs(std::move(gbs)) {
+        current_track = this->gbs.first_track > 0 ? this->gbs.first_track - 1 : 0;
+
+        const uint8_t *data = image.bytes().data() + GBS_HEADER_SIZE;
+        size_t data_len = image.file_length() - GBS_HEADER_SIZE;
+
+        size_t image_len = this->gbs.load_address + data_len;
+        image_len = std::max<size_t>((image_len + 0x3FFF) & ~static_cast<size_t>(0x3FFF), 0x8000);
+
+        program.assign(image_len, 0xFF);
+        std::copy(data, data + data_len, program.begin() + this->gbs.load_address);
+
+        build_driver();
+    }
+
+    const GBSHeader &GBSMapper::gbs_header() const { return gbs; }
+
+    std::span<const uint8_t> GBSMapper::program_bytes() const { return program; }
+
+    uint8_t GBSMapper::track_count() const { return gbs.track_count; }
+
+    uint8_t GBSMapper::track() const { return current_track; }
+
+    void GBSMapper::select_track(uint8_t track) {
+        current_track = track % gbs.track_count;
+
+        if (track_operand < program.size()) {
+            program[track_operand] = current_track;
         }
     }
 
-    void MBC5::load_sram_from_file() {
-        if (!has_battery()) {
-            return;
+    void GBSMapper::reset() {
+        rom_bank_num = 1;
+        ram.fill(0);
+    }
+
+    void GBSMapper::build_driver() {
+        std::fill(program.begin(), program.begin() + gbs.load_address, 0x00);
+
+        // RST vectors are relative to the load address
+        for (uint16_t vector = 0; vector < 0x40; vector += 8) {
+            uint16_t target = gbs.load_address + vector;
+            program[vector] = 0xC3; // JP u16
+            program[vector + 1] = target & 0xFF;
+            program[vector + 2] = target >> 8;
         }
 
-        std::filesystem::path path = header_.file_path;
-        path += ".sram";
+        // Interrupts only wake the driver from HALT
+        for (uint16_t vector = 0x40; vector <= 0x60; vector += 8) {
+            program[vector] = 0xD9; // RETI
+        }
 
-        std::ifstream sram(path, std::ios::binary | std::ios::ate);
-        if (sram) {
-            auto len = sram.tellg();
+        bool timer_driven = (gbs.timer_control & 0x04) != 0;
+        bool double_speed = (gbs.timer_control & 0x80) != 0;
 
-            sram.seekg(0);
+        std::vector<uint8_t> code{};
+        auto emit = [&code](std::initializer_list<uint8_t> bytes) {
+            code.insert(code.end(), bytes);
+        };
+        auto low = [](uint16_t value) { return static_cast<uint8_t>(value & 0xFF); };
+        auto high = [](uint16_t value) { return static_cast<uint8_t>(value >> 8); };
 
-            sram.read(reinterpret_cast<char *>(eram.data()), len);
-            sram.close();
+        emit({0xF3});                                                  // DI
+        emit({0x31, low(gbs.stack_pointer), high(gbs.stack_pointer)}); // LD SP, u16
+
+        if (double_speed) {
+            emit({0x3E, 0x01}); // LD A, 1
+            emit({0xE0, 0x4D}); // LDH (KEY1), A
+            emit({0x10, 0x00}); // STOP
+        }
+
+        emit({0x3E, gbs.timer_modulo});                               // LD A, TMA
+        emit({0xE0, 0x06});                                           // LDH (TMA), A
+        emit({0x3E, static_cast<uint8_t>(gbs.timer_control & 0x07)}); // LD A, TAC
+        emit({0xE0, 0x07});                                           // LDH (TAC), A
+        emit({0x3E, current_track});                                  // LD A, track
+        track_operand = static_cast<uint16_t>(GBS_DRIVER_ADDRESS + code.size() - 1);
+
+        emit({0xCD, low(gbs.init_address), high(gbs.init_address)}); // CALL init
+        emit({0x3E, timer_driven ? INT_TIMER_BIT : INT_VBLANK_BIT}); // LD A, IE
+        emit({0xE0, 0xFF});                                          // LDH (IE), A
+        emit({0xAF});                                                // XOR A
+        emit({0xE0, 0x0F});                                          // LDH (IF), A
+        emit({0xFB});                                                // EI
+        emit({0x76});                                                // HALT
+        emit({0xCD, low(gbs.play_address), high(gbs.play_address)}); // CALL play
+        emit({0x18, 0xFA});                                          // JR HALT
+
+        std::copy(code.begin(), code.end(), program.begin() + GBS_DRIVER_ADDRESS);
+    }
+
+    void GBSMapper::write(uint16_t address, uint8_t value) {
+        if (address >= 0x2000 && address < 0x4000) {
+            rom_bank_num = value == 0 ? 1 : value;
         }
     }
 
-    void MBC5::tick(int32_t cycles) {}
+    uint8_t GBSMapper::read_ram(uint16_t address) { return ram[address]; }
+
+    void GBSMapper::write_ram(uint16_t address, uint8_t value) { ram[address] = value; }
+
+    std::array<size_t, 2> GBSMapper::rom_banks(size_t bank_count) const {
+        return {0, rom_bank_num % bank_count};
+    }
+
+    const uint8_t *GBSMapper::ram_pointer(uint16_t address) const {
+        return page_pointer(ram.data(), ram.size(), address);
+    }
+
+    std::span<uint8_t> GBSMapper::battery_ram() { return {}; }
+
+    uint64_t GBSMapper::take_dirty_pages() { return 0; }
+
+    void GBSMapper::serialize(StateArchive &archive) {
+        archive(current_track, rom_bank_num, ram);
+
+        // The track number lives in the driver code as well
+        if (archive.loading()) {
+            select_track(current_track);
+        }
+    }
 }
@@ -17,14 +17,19 @@
 */
 
 #pragma once
+#include "RomImage.hpp"
 #include <array>
 #include <cinttypes>
 #include <filesystem>
 #include <memory>
+#include <span>
 #include <string>
+#include <variant>
 #include <vector>
 
 namespace GB {
+    class StateArchive;
+
     enum class RomSize {
         Rom32KB = 0,
         Rom64KB = 1,
@@ -65,129 +70,94 @@ namespace GB {
         uint16_t checksum = 0;
         RomSize rom_size = RomSize::Rom32KB;
         RamSize ram_size = RamSize::NoRam;
+        bool is_gbs = false;
     };
 
-    class Cartridge {
-    public:
-        explicit Cartridge(CartHeader &&header);
-        virtual ~Cartridge() = default;
-        Cartridge(const Cartridge &) = delete;
-        Cartridge(Cartridge &&) = delete;
-        Cartridge &operator=(const Cartridge &) = delete;
-        Cartridge &operator=(Cartridge &&) = delete;
-
-        const CartHeader &header() const;
-        virtual bool has_battery() const = 0;
-
-        virtual void reset() = 0;
-
-        virtual void init_banks(std::ifstream &rom_stream) = 0;
-
-        virtual uint8_t read(uint16_t address) = 0;
-        virtual void write(uint16_t address, uint8_t value) = 0;
-        virtual uint8_t read_ram(uint16_t address) = 0;
-        virtual void write_ram(uint16_t address, uint8_t value) = 0;
+    // Everything parse_cart_header looks at lies below this offset
+    constexpr size_t CART_HEADER_END = 0x150;
 
-        virtual void save_sram_to_file() = 0;
-        virtual void load_sram_from_file() = 0;
-        virtual void tick(int32_t cycles) = 0;
+    // Fills header from the start of a ROM or GBS file, file_path is left alone
+    bool parse_cart_header(std::span<const uint8_t> bytes, CartHeader &header);
 
-        static std::unique_ptr<Cartridge> from_file(std::filesystem::path rom_path);
-        static Cartridge *from_file_raw_ptr(std::filesystem::path rom_path);
+    // Battery RAM is tracked for saving in pages of this size, one bit per page
+    constexpr size_t SAVE_PAGE_SIZE = 0x800;
 
-    protected:
-        CartHeader header_;
-    };
-
-    class ROM : public Cartridge {
+    // Mappers only hold banking state. ROM reads never reach them, the cartridge keeps a pointer
+    // per 16 KiB slot that is recomputed from rom_banks() after every register write.
+    class ROM {
     public:
-        explicit ROM(CartHeader &&header);
-        ~ROM() = default;
-        ROM(const ROM &) = delete;
-        ROM(ROM &&) = delete;
-        ROM &operator=(const ROM &) = delete;
-        ROM &operator=(ROM &&) = delete;
-
-        bool has_battery() const override { return false; }
+        explicit ROM(const CartHeader &header);
 
-        void reset() override;
-        void init_banks(std::ifstream &rom_stream) override;
+        bool has_battery() const { return false; }
+        size_t allocated_bytes() const { return 0; }
+        void reset();
 
-        uint8_t read(uint16_t address) override;
-        void write(uint16_t address, uint8_t value) override;
-        uint8_t read_ram(uint16_t address) override;
-        void write_ram(uint16_t address, uint8_t value) override;
+        void write(uint16_t address, uint8_t value);
+        uint8_t read_ram(uint16_t address);
+        void write_ram(uint16_t address, uint8_t value);
 
-        void save_sram_to_file() override;
-        void load_sram_from_file() override;
-        void tick(int32_t cycles) override;
-
-    private:
-        std::vector<uint8_t> rom;
+        std::array<size_t, 2> rom_banks(size_t bank_count) const;
+        const uint8_t *ram_pointer(uint16_t address) const;
+        std::span<uint8_t> battery_ram();
+        uint64_t take_dirty_pages();
+        void serialize(StateArchive &archive);
     };
 
-    class MBC1 : public Cartridge {
+    class MBC1 {
     public:
-        explicit MBC1(CartHeader &&header);
-        ~MBC1() = default;
-        MBC1(const MBC1 &) = delete;
-        MBC1(MBC1 &&) = delete;
-        MBC1 &operator=(const MBC1 &) = delete;
-        MBC1 &operator=(MBC1 &&) = delete;
-
-        bool has_battery() const override;
+        explicit MBC1(const CartHeader &header);
 
-        void reset() override;
-        void init_banks(std::ifstream &rom_stream) override;
+        bool has_battery() const { return battery; }
+        size_t allocated_bytes() const { return eram.capacity(); }
+        void reset();
 
-        uint8_t read(uint16_t addr) override;
-        void write(uint16_t addr, uint8_t value) override;
-        uint8_t read_ram(uint16_t addr) override;
-        void write_ram(uint16_t addr, uint8_t value) override;
+        void write(uint16_t address, uint8_t value);
+        uint8_t read_ram(uint16_t address);
+        void write_ram(uint16_t address, uint8_t value);
 
-        void save_sram_to_file() override;
-        void load_sram_from_file() override;
-        void tick(int32_t cycles) override;
+        std::array<size_t, 2> rom_banks(size_t bank_count) const;
+        const uint8_t *ram_pointer(uint16_t address) const;
+        std::span<uint8_t> battery_ram();
+        uint64_t take_dirty_pages();
+        void serialize(StateArchive &archive);
 
     private:
+        bool battery = false, large_rom = false, large_ram = false;
+
         bool mode = 0;
         int32_t rom_bank_num = 1;
         int32_t bank_upper_bits = 0;
 
         bool ram_enabled = false;
-        std::array<uint8_t, 32768> eram{};
-        std::vector<uint8_t> rom{};
+        std::vector<uint8_t> eram{};
+        uint64_t dirty_pages = 0;
     };
 
-    class MBC2 : public Cartridge {
+    class MBC2 {
     public:
-        explicit MBC2(CartHeader &&header);
-        ~MBC2() = default;
-        MBC2(const MBC2 &) = delete;
-        MBC2(MBC2 &&) = delete;
-        MBC2 &operator=(const MBC2 &) = delete;
-        MBC2 &operator=(MBC2 &&) = delete;
-
-        bool has_battery() const override;
+        explicit MBC2(const CartHeader &header);
 
-        void reset() override;
-        void init_banks(std::ifstream &rom_stream) override;
+        bool has_battery() const { return battery; }
+        size_t allocated_bytes() const { return 0; }
+        void reset();
 
-        uint8_t read(uint16_t address) override;
-        void write(uint16_t address, uint8_t value) override;
-        uint8_t read_ram(uint16_t address) override;
-        void write_ram(uint16_t address, uint8_t value) override;
+        void write(uint16_t address, uint8_t value);
+        uint8_t read_ram(uint16_t address);
+        void write_ram(uint16_t address, uint8_t value);
 
-        void save_sram_to_file() override;
-        void load_sram_from_file() override;
-        void tick(int32_t cycles) override;
+        std::array<size_t, 2> rom_banks(size_t bank_count) const;
+        const uint8_t *ram_pointer(uint16_t address) const;
+        std::span<uint8_t> battery_ram();
+        uint64_t take_dirty_pages();
+        void serialize(StateArchive &archive);
 
     private:
+        bool battery = false;
         uint16_t rom_bank_num = 1;
 
         bool ram_enabled = false;
         std::array<uint8_t, 512> ram{};
-        std::vector<uint8_t> rom{};
+        uint64_t dirty_pages = 0;
     };
 
     class RTCCounter {
@@ -210,75 +180,211 @@ namespace GB {
         uint16_t days = 0;
     };
 
-    class MBC3 : public Cartridge {
+    // Size of the RTC block BGB and VBA-M append to the save file
+    constexpr size_t RTC_FOOTER_SIZE = 48;
+
+    // The RTC is not ticked, the registers are brought up to date from the core clock only when
+    // the game can observe them: on latch, on register writes and before saving.
+    class MBC3 {
     public:
-        explicit MBC3(CartHeader &&header);
-        ~MBC3() = default;
-        MBC3(const MBC3 &) = delete;
-        MBC3(MBC3 &&) = delete;
-        MBC3 &operator=(const MBC3 &) = delete;
-        MBC3 &operator=(MBC3 &&) = delete;
+        explicit MBC3(const CartHeader &header);
 
-        bool has_rtc() const;
-        bool has_battery() const override;
+        bool has_rtc() const { return rtc_present; }
+        bool has_battery() const { return battery; }
+        size_t allocated_bytes() const { return eram.capacity(); }
+        void reset();
 
-        void reset() override;
-        void init_banks(std::ifstream &rom_stream) override;
+        void write(uint16_t address, uint8_t value);
+        uint8_t read_ram(uint16_t address);
+        void write_ram(uint16_t address, uint8_t value);
 
-        uint8_t read(uint16_t addr) override;
-        void write(uint16_t addr, uint8_t value) override;
-        uint8_t read_ram(uint16_t addr) override;
-        void write_ram(uint16_t addr, uint8_t value) override;
+        std::array<size_t, 2> rom_banks(size_t bank_count) const;
+        const uint8_t *ram_pointer(uint16_t address) const;
+        std::span<uint8_t> battery_ram();
+        uint64_t take_dirty_pages();
+        void serialize(StateArchive &archive);
 
-        void save_sram_to_file() override;
-        void load_sram_from_file() override;
-        void tick(int32_t cycles) override;
+        void attach_clock(const uint64_t *source);
+        std::array<uint8_t, RTC_FOOTER_SIZE> save_rtc();
+        void load_rtc(std::span<const uint8_t> footer);
 
     private:
+        void sync_rtc();
+        void advance_rtc(uint64_t seconds);
+        void increment_rtc_second();
+
+        bool battery = false, rtc_present = false;
         int32_t rom_bank_num = 1;
         int32_t ram_rtc_select = 0;
 
         bool ram_rtc_enabled = false;
-        std::array<uint8_t, 65536> eram{};
-        std::vector<uint8_t> rom{};
+        std::vector<uint8_t> eram{};
+        uint64_t dirty_pages = 0;
 
         uint8_t latch_byte = 0;
 
+        const uint64_t *clock = nullptr;
+        uint64_t rtc_base = 0;
         int32_t rtc_cycles = 0;
         RTCTimePoint rtc{}, shadow_rtc{};
         uint16_t rtc_ctrl = 0;
     };
 
-    class MBC5 : public Cartridge {
+    class MBC5 {
     public:
-        MBC5(CartHeader &&header);
-        ~MBC5() = default;
-        MBC5(const MBC5 &) = delete;
-        MBC5(MBC5 &&) = delete;
-        MBC5 &operator=(const MBC5 &) = delete;
-        MBC5 &operator=(MBC5 &&) = delete;
+        explicit MBC5(const CartHeader &header);
 
-        bool has_battery() const override;
+        bool has_battery() const { return battery; }
+        size_t allocated_bytes() const { return eram.capacity(); }
+        void reset();
 
-        void reset() override;
-        void init_banks(std::ifstream &rom_stream) override;
+        void write(uint16_t address, uint8_t value);
+        uint8_t read_ram(uint16_t address);
+        void write_ram(uint16_t address, uint8_t value);
 
-        uint8_t read(uint16_t addr) override;
-        void write(uint16_t addr, uint8_t value) override;
-        uint8_t read_ram(uint16_t addr) override;
-        void write_ram(uint16_t addr, uint8_t value) override;
-
-        void save_sram_to_file() override;
-        void load_sram_from_file() override;
-        void tick(int32_t cycles) override;
+        std::array<size_t, 2> rom_banks(size_t bank_count) const;
+        const uint8_t *ram_pointer(uint16_t address) const;
+        std::span<uint8_t> battery_ram();
+        uint64_t take_dirty_pages();
+        void serialize(StateArchive &archive);
 
     private:
+        bool battery = false;
         int32_t rom_bank_num = 1;
         int32_t bank_upper_bits = 0;
         int32_t ram_bank_num = 0;
 
         bool ram_enabled = false;
-        std::array<uint8_t, 131072> eram{};
-        std::vector<uint8_t> rom{};
+        std::vector<uint8_t> eram{};
+        uint64_t dirty_pages = 0;
+    };
+
+    struct GBSHeader {
+        uint8_t version = 0;
+        uint8_t track_count = 0;
+        uint8_t first_track = 0;
+        uint16_t load_address = 0;
+        uint16_t init_address = 0;
+        uint16_t play_address = 0;
+        uint16_t stack_pointer = 0;
+        uint8_t timer_modulo = 0;
+        uint8_t timer_control = 0;
+        std::string title;
+        std::string author;
+        std::string copyright;
+    };
+
+    // Maps a GBS sound file as a cartridge. A small driver placed below the load address
+    // calls init for the selected track and then play on every VBlank or timer interrupt.
+    class GBSMapper {
+    public:
+        GBSMapper(const CartHeader &header, GBSHeader &&gbs, const RomImage &image);
+
+        bool has_battery() const { return false; }
+        size_t allocated_bytes() const { return program.capacity(); }
+
+        const GBSHeader &gbs_header() const;
+        std::span<const uint8_t> program_bytes() const;
+        uint8_t track_count() const;
+        uint8_t track() const;
+        void select_track(uint8_t track);
+
+        void reset();
+
+        void write(uint16_t address, uint8_t value);
+        uint8_t read_ram(uint16_t address);
+        void write_ram(uint16_t address, uint8_t value);
+
+        std::array<size_t, 2> rom_banks(size_t bank_count) const;
+        const uint8_t *ram_pointer(uint16_t address) const;
+        std::span<uint8_t> battery_ram();
+        uint64_t take_dirty_pages();
+        void serialize(StateArchive &archive);
+
+    private:
+        void build_driver();
+
+        GBSHeader gbs;
+        uint8_t current_track = 0;
+        int32_t rom_bank_num = 1;
+        uint16_t track_operand = 0;
+
+        // Header-less copy of the file placed at the load address, below it lives the driver
+        std::vector<uint8_t> program{};
+        std::array<uint8_t, 8192> ram{};
+    };
+
+    class Cartridge {
+    public:
+        using Mapper = std::variant<ROM, MBC1, MBC2, MBC3, MBC5, GBSMapper>;
+
+        ~Cartridge() = default;
+        Cartridge(const Cartridge &) = delete;
+        Cartridge(Cartridge &&) = delete;
+        Cartridge &operator=(const Cartridge &) = delete;
+        Cartridge &operator=(Cartridge &&) = delete;
+
+        const CartHeader &header() const;
+        bool has_battery() const;
+        GBSMapper *gbs();
+
+        void reset();
+
+        uint8_t read(uint16_t address) const { return rom_banks[address >> 14][address & 0x3FFF]; }
+        void write(uint16_t address, uint8_t value);
+        uint8_t read_ram(uint16_t address);
+        void write_ram(uint16_t address, uint8_t value);
+
+        // Pointer to the byte at address that stays valid up to the end of its 4 KiB page, or
+        // nullptr when the region is not plain memory and has to be read byte by byte
+        const uint8_t *memory_pointer(uint16_t address) const;
+
+        void save_sram_to_file();
+        void load_sram_from_file();
+
+        // Copies battery RAM pages written since the last call into image, which mirrors the
+        // save file. Returns false when force is unset and there was nothing new.
+        bool update_save_image(std::vector<uint8_t> &image, bool force);
+        std::filesystem::path save_path() const;
+
+        // Memory owned by this cartridge, the ROM image is shared and not included
+        size_t resident_bytes() const;
+
+        // Counter of T-cycles at 4 MiHz the RTC is measured against, it has to outlive any
+        // later call into the cartridge
+        void attach_clock(const uint64_t *clock);
+
+        // Banking registers and cartridge RAM, loaded RAM pages that differ count as written for
+        // the save file
+        void serialize(StateArchive &archive);
+
+        static std::unique_ptr<Cartridge> from_file(std::filesystem::path rom_path);
+        static Cartridge *from_file_raw_ptr(std::filesystem::path rom_path);
+        // No battery file is read or written for a cartridge without a path
+        static std::unique_ptr<Cartridge> from_memory(std::span<const uint8_t> rom);
+        // A cartridge at power on sharing this one's ROM image, without a path so no battery file
+        // is read or written. Loading a state taken on this cartridge copies its RAM and registers.
+        std::unique_ptr<Cartridge> share_image() const;
+
+    private:
+        template <typename T, typename... Args>
+        Cartridge(CartHeader &&header, std::shared_ptr<const RomImage> image,
+                  std::in_place_type_t<T> type, Args &&...args)
+            : header_(std::move(header)), image(std::move(image)),
+              mapper(type, header_, std::forward<Args>(args)...) {
+            attach_rom();
+        }
+
+        static Cartridge *from_image(std::shared_ptr<const RomImage> image,
+                                     std::filesystem::path rom_path);
+
+        void attach_rom();
+        void update_banks();
+
+        CartHeader header_;
+        std::shared_ptr<const RomImage> image;
+        std::span<const uint8_t> rom{};
+        std::array<const uint8_t *, 2> rom_banks{};
+        Mapper mapper;
     };
 }
@@ -39,6 +39,11 @@ namespace GB {
         AutoSelect,
     };
 
+    enum class AudioMode {
+        Full,
+        Silent,
+    };
+
     consteval uint16_t RGB555ToUInt(uint16_t r, uint16_t g, uint16_t b) {
         r &= 0x1F;
         g &= 0x1F;
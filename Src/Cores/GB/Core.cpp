@@ -19,10 +19,13 @@
 #include "Core.hpp"
 #include "Constants.hpp"
 #include "PPU.hpp"
+#include "State.hpp"
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 
 namespace GB {
-    Core::Core() : bus(this), ppu(this), timer(this), cpu(this), dma(this) {}
+    Core::Core() : bus(this), ppu(this), timer(this), cpu(this), dma(this), oam_dma(this) {}
 
     void Core::initialize(Cartridge *cart) {
         ready_to_run = cart ? true : false;
@@ -30,6 +33,7 @@ namespace GB {
             return;
         }
 
+        cart->attach_clock(&clock_cycles_);
         cart->reset();
         bootstrap.clear();
         apu.reset();
@@ -38,6 +42,7 @@ namespace GB {
         pad.reset();
         bus.reset(cart);
         dma.reset();
+        oam_dma.reset();
 
         if (ready_to_run) {
 
@@ -68,6 +73,7 @@ namespace GB {
             return;
         }
 
+        cart->attach_clock(&clock_cycles_);
         cart->reset();
         bootstrap.clear();
         apu.reset();
@@ -76,6 +82,7 @@ namespace GB {
         pad.reset();
         bus.reset(cart);
         dma.reset();
+        oam_dma.reset();
 
         if (ready_to_run) {
             load_bootstrap(bootstrap_path);
@@ -96,7 +103,10 @@ namespace GB {
     void Core::run_for_frames(int32_t frames) {
         while (frames-- && ready_to_run) {
             while (cycle_count < CYCLES_PER_FRAME && !cpu.stopped()) {
-                dma.tick();
+                if (dma.hblank_pending()) {
+                    dma.run_hblank_transfer();
+                }
+
                 cpu.step();
             }
 
@@ -106,14 +116,41 @@ namespace GB {
         }
     }
 
+    void Core::run_for_cycles(int32_t cycles) {
+        uint64_t target = elapsed_cycles_ + static_cast<uint64_t>(std::max(cycles, 0));
+
+        while (elapsed_cycles_ < target && ready_to_run && !cpu.stopped()) {
+            if (dma.hblank_pending()) {
+                dma.run_hblank_transfer();
+            }
+
+            cpu.step();
+
+            if (cycle_count >= CYCLES_PER_FRAME) {
+                cycle_count -= CYCLES_PER_FRAME;
+            }
+        }
+    }
+
     void Core::tick_subcomponents(int32_t cycles) {
         int32_t adjusted_cycles = cpu.double_speed() ? 2 : 4;
 
         while (cycles > 0) {
-            timer.update(4);
+            elapsed_cycles_ += 4;
+
+            if (elapsed_cycles_ >= timer.next_event()) {
+                timer.update();
+            }
+
             ppu.step(adjusted_cycles);
-            apu.step(adjusted_cycles);
-            bus.cart->tick(adjusted_cycles);
+
+            // Channel timers only feed the sample output, everything the CPU can observe
+            // (NR52 status, length, sweep, envelope) is driven by the frame sequencer in Timer
+            if (audio_mode_ == AudioMode::Full) {
+                apu.step(adjusted_cycles);
+            }
+
+            clock_cycles_ += adjusted_cycles;
             cycle_count += adjusted_cycles;
             cycles -= 4;
         }
@@ -138,5 +175,100 @@ namespace GB {
         }
     }
 
+    void Core::set_audio_mode(AudioMode mode) { audio_mode_ = mode; }
+
+    AudioMode Core::audio_mode() const { return audio_mode_; }
+
     uint8_t Core::read_bootstrap(uint16_t address) { return bootstrap[address]; }
+
+    size_t Core::resident_bytes() const {
+        size_t bytes = sizeof(Core) + bootstrap.capacity() + ppu.allocated_bytes();
+
+        if (bus.cart) {
+            bytes += bus.cart->resident_bytes();
+        }
+
+        return bytes;
+    }
+
+    size_t Core::state_size() {
+        if (!ready_to_run) {
+            return 0;
+        }
+
+        StateHeader header{};
+        auto archive = StateArchive::measure();
+        archive(header);
+        serialize(archive);
+        return archive.offset();
+    }
+
+    bool Core::save_state(std::span<uint8_t> buffer) {
+        size_t size = state_size();
+
+        if (size == 0 || buffer.size() < size) {
+            return false;
+        }
+
+        StateHeader header{};
+        header.size = static_cast<uint32_t>(size);
+        header.rom_checksum = bus.cart->header().checksum;
+        header.header_checksum = bus.cart->header().header_checksum;
+
+        auto archive = StateArchive::save(buffer.first(size));
+        archive(header);
+        serialize(archive);
+        return archive.ok();
+    }
+
+    bool Core::load_state(std::span<const uint8_t> buffer) {
+        StateHeader header{};
+
+        if (!ready_to_run || buffer.size() < sizeof(header)) {
+            return false;
+        }
+
+        std::memcpy(&header, buffer.data(), sizeof(header));
+        const auto &cart_header = bus.cart->header();
+
+        if (header.magic != STATE_MAGIC || header.version != STATE_VERSION ||
+            header.size < sizeof(header) || header.size > buffer.size() ||
+            header.rom_checksum != cart_header.checksum ||
+            header.header_checksum != cart_header.header_checksum) {
+            return false;
+        }
+
+        auto archive = StateArchive::load(buffer.first(header.size));
+        archive(header);
+        serialize(archive);
+        return archive.ok() && archive.offset() == header.size;
+    }
+
+    void Core::serialize(StateArchive &archive) {
+        cpu.serialize(archive);
+        bus.serialize(archive);
+        bus.cart->serialize(archive);
+        ppu.serialize(archive);
+        apu.serialize(archive);
+        timer.serialize(archive);
+        dma.serialize(archive);
+        oam_dma.serialize(archive);
+        pad.serialize(archive);
+        archive(cycle_count, elapsed_cycles_, clock_cycles_);
+
+        // A state taken during the boot ROM needs it to continue
+        auto bootstrap_size = static_cast<uint32_t>(bootstrap.size());
+        archive(bootstrap_size);
+
+        if (archive.loading()) {
+            if (bootstrap_size > 0x900) {
+                archive.fail();
+                return;
+            }
+
+            bootstrap.resize(bootstrap_size);
+        }
+
+        archive.bytes(bootstrap);
+    }
 }
\ No newline at end of file
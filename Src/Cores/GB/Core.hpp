@@ -20,6 +20,7 @@
 #include "APU.hpp"
 #include "Bus.hpp"
 #include "Cartridge.hpp"
+#include "Constants.hpp"
 #include "DMA.hpp"
 #include "PPU.hpp"
 #include "Pad.hpp"
@@ -27,9 +28,13 @@
 #include "Timer.hpp"
 #include <cinttypes>
 #include <filesystem>
+#include <span>
 #include <vector>
 
 namespace GB {
+    // A core holds all of its own state. Separate cores share nothing mutable, only the CPU's
+    // opcode tables and memory-mapped ROM images, which are read-only once built, so any number
+    // of them can run at once as long as each is driven by a single thread at a time.
     class Core {
     public:
         Gamepad pad;
@@ -39,20 +44,47 @@ namespace GB {
         Timer timer;
         SM83 cpu;
         DMAController dma;
+        OAMDMAController oam_dma;
         Core();
 
         void initialize(Cartridge *cart);
         void initialize_with_bootstrap(Cartridge *cart, ConsoleType console,
                                        std::filesystem::path bootstrap_path);
         void run_for_frames(int32_t frames);
+        // Runs whole instructions until elapsed_cycles() has advanced by at least cycles
+        void run_for_cycles(int32_t cycles);
         void tick_subcomponents(int32_t cycles);
         void load_bootstrap(std::filesystem::path path);
+        void set_audio_mode(AudioMode mode);
+        AudioMode audio_mode() const;
+
+        // T-cycles at single speed (4 per M-cycle) since construction, never reset
+        uint64_t elapsed_cycles() const { return elapsed_cycles_; }
+
+        // T-cycles of real time at 4 MiHz, advances half as fast per M-cycle in double speed
+        uint64_t clock_cycles() const { return clock_cycles_; }
 
         uint8_t read_bootstrap(uint16_t address);
 
+        // Bytes held by this core and its cartridge, excluding the shared ROM image
+        size_t resident_bytes() const;
+
+        // States are only taken and restored between run calls with a cartridge loaded, and
+        // only load into a core running the same ROM. state_size() is 0 without a cartridge.
+        // A state that passes the header checks but turns out truncated leaves the core
+        // partly loaded, initialize() it again before running.
+        size_t state_size();
+        bool save_state(std::span<uint8_t> buffer);
+        bool load_state(std::span<const uint8_t> buffer);
+
     private:
+        void serialize(StateArchive &archive);
+
         bool ready_to_run = false;
+        AudioMode audio_mode_ = AudioMode::Full;
         int32_t cycle_count = 0;
+        uint64_t elapsed_cycles_ = 0;
+        uint64_t clock_cycles_ = 0;
         std::vector<uint8_t> bootstrap{};
     };
 }
\ No newline at end of file
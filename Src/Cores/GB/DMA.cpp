@@ -19,9 +19,16 @@
 #include "DMA.hpp"
 #include "Core.hpp"
 #include "PPU.hpp"
+#include "State.hpp"
+#include <algorithm>
+#include <array>
 #include <stdexcept>
 
 namespace GB {
+    constexpr int32_t DMA_BLOCK_SIZE = 16;
+    constexpr int32_t DMA_BLOCK_CYCLES = 32;
+    constexpr int32_t OAM_DMA_LENGTH = 160;
+
     DMAController::DMAController(Core *core) : core(core) {
         if (!core) {
             throw std::invalid_argument("Core cannot be null.");
@@ -38,7 +45,7 @@ namespace GB {
 
     void DMAController::reset() {
         active = false;
-        is_mode0 = false;
+        hblank_pending_ = false;
         src_address = 0;
         dst_address = 0;
         current_length = 0x7F;
@@ -53,6 +60,14 @@ namespace GB {
         } else {
             active = ctrl & 0x80;
         }
+
+        // The CPU is halted for the whole general purpose transfer
+        if (active && type == DMAType::GDMA) {
+            transfer_blocks(current_length + 1);
+
+            current_length = 0x7F;
+            active = false;
+        }
     }
 
     void DMAController::set_hdma1(uint8_t high) {
@@ -81,37 +96,68 @@ namespace GB {
         return stat | (current_length & 0x7F);
     }
 
-    void DMAController::tick() {
-        bool mode0_now = (core->ppu.read_register(0x41) & 0x3) == HBLANK;
+    void DMAController::run_hblank_transfer() {
+        hblank_pending_ = false;
 
-        if (active) {
-            switch (type) {
-            case DMAType::GDMA: {
+        if (!active || type != DMAType::HDMA) {
+            return;
+        }
 
-                for (int i = 0; i < (current_length + 1); ++i) {
-                    transfer_block();
-                }
-                current_length = 0x7F;
-                active = false;
-                break;
-            }
-            case DMAType::HDMA: {
-                if (!is_mode0 && mode0_now) {
-                    transfer_block();
-
-                    if (current_length) {
-                        current_length--;
-                    } else {
-                        current_length = 0x7F;
-                        active = false;
-                    }
-                }
-                break;
+        transfer_blocks(1);
+
+        if (current_length) {
+            current_length--;
+        } else {
+            current_length = 0x7F;
+            active = false;
+        }
+    }
+
+    void DMAController::serialize(StateArchive &archive) {
+        archive(active, hblank_pending_, current_length, src_address, dst_address, type);
+    }
+
+    void DMAController::transfer_blocks(int32_t count) {
+        int32_t remaining = count * DMA_BLOCK_SIZE;
+
+        if (!can_bulk_copy(remaining)) {
+            for (int32_t i = 0; i < count; ++i) {
+                transfer_block();
             }
+
+            return;
+        }
+
+        // Plain memory can't change while the CPU is stalled, so the data is copied in runs that
+        // stop at source page and VRAM wrap boundaries and the stall is charged in one go
+        while (remaining > 0) {
+            int32_t source_left = 0x1000 - (src_address & 0xFFF);
+            int32_t vram_left = 0x2000 - (dst_address & 0x1FFF);
+            int32_t length = std::min({remaining, source_left, vram_left});
+            const uint8_t *source = core->bus.memory_pointer(src_address);
+
+            core->ppu.write_vram_block(dst_address & 0x1FFF, {source, static_cast<size_t>(length)});
+
+            src_address += length;
+            dst_address += length;
+            remaining -= length;
+        }
+
+        core->tick_subcomponents(count * DMA_BLOCK_CYCLES);
+    }
+
+    bool DMAController::can_bulk_copy(int32_t length) const {
+        for (int32_t offset = 0; offset < length;) {
+            uint16_t address = src_address + offset;
+
+            if (!core->bus.memory_pointer(address)) {
+                return false;
             }
+
+            offset += 0x1000 - (address & 0xFFF);
         }
 
-        is_mode0 = mode0_now;
+        return true;
     }
 
     void DMAController::transfer_block() {
@@ -135,4 +181,42 @@ namespace GB {
         }
     }
 
-}
\ No newline at end of file
+    OAMDMAController::OAMDMAController(Core *core) : core(core) {
+        if (!core) {
+            throw std::invalid_argument("Core cannot be null.");
+        }
+    }
+
+    uint8_t OAMDMAController::get_source() const { return source_page; }
+
+    void OAMDMAController::reset() {
+        source_page = 0xFF;
+        start_cycle = 0;
+        end_cycle = 0;
+    }
+
+    void OAMDMAController::start(uint8_t source) {
+        // Sources past WRAM are served by its echo
+        uint16_t address = (source >= 0xE0 ? source - 0x20 : source) << 8;
+        const uint8_t *data = core->bus.memory_pointer(address);
+        std::array<uint8_t, OAM_DMA_LENGTH> buffer{};
+
+        if (!data) {
+            for (int32_t i = 0; i < OAM_DMA_LENGTH; ++i) {
+                buffer[i] = core->bus.read(address + i);
+            }
+
+            data = buffer.data();
+        }
+
+        core->ppu.write_oam_block({data, OAM_DMA_LENGTH});
+
+        source_page = source;
+        start_cycle = core->elapsed_cycles() + 4;
+        end_cycle = start_cycle + (OAM_DMA_LENGTH * 4);
+    }
+
+    void OAMDMAController::serialize(StateArchive &archive) {
+        archive(source_page, start_cycle, end_cycle);
+    }
+}
@@ -21,6 +21,7 @@
 
 namespace GB {
     class Core;
+    class StateArchive;
 
     enum class DMAType { GDMA, HDMA };
 
@@ -41,16 +42,44 @@ namespace GB {
         void set_hdma3(uint8_t high);
         void set_hdma4(uint8_t low);
 
-        void tick();
+        // Called by the PPU when it enters mode 0, the block is copied at the next
+        // instruction boundary so the transfer never runs from inside PPU::step
+        void on_hblank() { hblank_pending_ = true; }
+        bool hblank_pending() const { return hblank_pending_; }
+        void run_hblank_transfer();
+        void serialize(StateArchive &archive);
 
     private:
+        void transfer_blocks(int32_t count);
         void transfer_block();
+        bool can_bulk_copy(int32_t length) const;
 
-        bool active = false, is_mode0 = false;
+        bool active = false, hblank_pending_ = false;
         uint8_t current_length = 0x7F;
         uint16_t src_address = 0, dst_address = 0;
         DMAType type = DMAType::GDMA;
 
         Core *core;
     };
+
+    // OAM DMA started through FF46. The 160 bytes are copied when the transfer starts and only
+    // what the CPU can observe is timed: after one setup cycle, the next 160 M-cycles can only
+    // reach HRAM and IO.
+    class OAMDMAController {
+    public:
+        OAMDMAController(Core *core);
+
+        uint8_t get_source() const;
+        bool blocks_bus(uint64_t now) const { return now > start_cycle && now <= end_cycle; }
+
+        void reset();
+        void start(uint8_t source);
+        void serialize(StateArchive &archive);
+
+    private:
+        uint8_t source_page = 0xFF;
+        uint64_t start_cycle = 0, end_cycle = 0;
+
+        Core *core;
+    };
 }
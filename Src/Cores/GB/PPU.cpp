@@ -19,6 +19,7 @@
 #include "PPU.hpp"
 #include "Constants.hpp"
 #include "Core.hpp"
+#include "State.hpp"
 #include <algorithm>
 #include <span>
 #include <stdexcept>
@@ -256,8 +257,12 @@ namespace GB {
         }
     }
 
-    std::span<uint8_t, LCD_WIDTH * LCD_HEIGHT * 4> PPU::framebuffer() {
-        return framebuffer_complete;
+    std::span<uint8_t, FRAMEBUFFER_SIZE> PPU::framebuffer() {
+        if (framebuffer_complete.empty()) {
+            framebuffer_complete.assign(FRAMEBUFFER_SIZE, 0);
+        }
+
+        return std::span<uint8_t, FRAMEBUFFER_SIZE>(framebuffer_complete.data(), FRAMEBUFFER_SIZE);
     }
 
     void PPU::reset() {
@@ -300,8 +305,12 @@ namespace GB {
         objects_on_scanline.fill(Object{});
 
         bg_color_table.fill(0);
-        internal_framebuffer.fill(0);
-        framebuffer_complete.fill(0);
+        std::fill(internal_framebuffer.begin(), internal_framebuffer.end(), 0);
+        std::fill(framebuffer_complete.begin(), framebuffer_complete.end(), 0);
+
+        if (render_enabled) {
+            allocate_framebuffers();
+        }
     }
 
     void PPU::set_post_boot_state() {
@@ -337,6 +346,8 @@ namespace GB {
     }
 
     void PPU::step(int32_t accumulated_cycles) {
+        const bool draw = render_enabled && !frame_skip;
+
         if (!(lcd_control & LCD_ENABLED_BIT)) {
             set_mode(HBLANK);
             previously_disabled = true;
@@ -401,7 +412,10 @@ namespace GB {
                     cycles = 0;
 
                     if (line_y > 153) {
-                        framebuffer_complete = internal_framebuffer;
+                        if (draw) {
+                            framebuffer_complete = internal_framebuffer;
+                        }
+
                         set_mode(OAM_SEARCH);
 
                         if ((status & OAM_STAT_INT_BIT) && allow_interrupt) {
@@ -420,13 +434,34 @@ namespace GB {
 
             case OAM_SEARCH: {
                 if (cycles == 80) {
-                    scan_oam();
+                    if (draw) {
+                        scan_oam();
+                    }
+
                     cycles = 0;
                     extra_cycles = 0;
 
                     set_mode(PIXEL_TRANSFER);
                     fetcher.reset();
                     bg_fifo.clear();
+
+                    if (!draw) {
+                        // Charge the penalties the skipped fetcher would have. A window starting
+                        // at the left edge replaces the background before its first push, so
+                        // the fine scroll is dropped only then.
+                        bool window = (lcd_control & WND_ENABLED_BIT) && window_draw_flag &&
+                                      window_x < 167;
+
+                        if (!window || window_x > 7) {
+                            extra_cycles += screen_scroll_x & 7;
+                        }
+
+                        if (window) {
+                            fetcher.clear_with_mode(FetchMode::Window);
+                            extra_cycles += 6;
+                        }
+                    }
+
                     continue;
                 }
 
@@ -435,7 +470,10 @@ namespace GB {
 
             case PIXEL_TRANSFER: {
                 if (cycles == 172 + extra_cycles) {
-                    render_objects();
+                    if (draw) {
+                        render_objects();
+                    }
+
                     cycles = 0;
 
                     set_mode(HBLANK);
@@ -448,7 +486,7 @@ namespace GB {
                     }
 
                     continue;
-                } else {
+                } else if (draw) {
                     render_scanline();
                 }
                 break;
@@ -462,6 +500,61 @@ namespace GB {
         }
     }
 
+    void PPU::set_render_enabled(bool enabled) {
+        render_enabled = enabled;
+
+        if (enabled) {
+            allocate_framebuffers();
+        } else {
+            internal_framebuffer = {};
+            framebuffer_complete = {};
+        }
+    }
+
+    void PPU::set_frame_skip(bool skip) { frame_skip = skip; }
+
+    size_t PPU::allocated_bytes() const {
+        return internal_framebuffer.capacity() + framebuffer_complete.capacity();
+    }
+
+    void PPU::serialize(StateArchive &archive) {
+        archive(fetcher, bg_fifo, window_draw_flag, previously_disabled, num_obj_on_scanline,
+                line_x);
+        archive(lcd_control, status, screen_scroll_y, screen_scroll_x, line_y, line_y_compare,
+                window_y, window_x, window_line_y);
+        archive(background_palette, object_palette_0, object_palette_1, vram_bank_select,
+                bg_palette_select, obj_palette_select, object_priority_mode);
+        archive(cycles, extra_cycles);
+        archive(obj_cram, bg_cram, vram, oam, objects_on_scanline, bg_color_table);
+
+        // A core that does not render passes over the pixels of one that did
+        bool has_frames = render_enabled;
+        archive(has_frames);
+
+        if (!has_frames) {
+            return;
+        }
+
+        if (archive.loading() && !render_enabled) {
+            archive.skip(FRAMEBUFFER_SIZE * 2);
+            return;
+        }
+
+        allocate_framebuffers();
+        archive.bytes(internal_framebuffer);
+        archive.bytes(framebuffer_complete);
+    }
+
+    void PPU::allocate_framebuffers() {
+        if (internal_framebuffer.empty()) {
+            internal_framebuffer.assign(FRAMEBUFFER_SIZE, 0);
+        }
+
+        if (framebuffer_complete.empty()) {
+            framebuffer_complete.assign(FRAMEBUFFER_SIZE, 0);
+        }
+    }
+
     void PPU::write_register(uint8_t reg, uint8_t value) {
         switch (reg) {
         case 0x40: {
@@ -485,10 +578,6 @@ namespace GB {
             line_y_compare = value;
             return;
         }
-        case 0x46: {
-            instant_dma(value);
-            return;
-        }
         case 0x47: {
             background_palette = value;
             return;
@@ -559,9 +648,6 @@ namespace GB {
         case 0x45: {
             return line_y_compare;
         }
-        case 0x46: {
-            return 0xFF;
-        }
         case 0x47: {
             return background_palette;
         }
@@ -603,12 +689,20 @@ namespace GB {
         vram[(vram_bank_select * 0x2000) + address] = value;
     }
 
+    void PPU::write_vram_block(uint16_t address, std::span<const uint8_t> data) {
+        std::copy(data.begin(), data.end(), vram.begin() + (vram_bank_select * 0x2000) + address);
+    }
+
     uint8_t PPU::read_vram(uint16_t address) const {
         return vram[(vram_bank_select * 0x2000) + address];
     }
 
     void PPU::write_oam(uint16_t address, uint8_t value) { oam[address] = value; }
 
+    void PPU::write_oam_block(std::span<const uint8_t> data) {
+        std::copy(data.begin(), data.end(), oam.begin());
+    }
+
     uint8_t PPU::read_oam(uint16_t address) const { return oam[address]; }
 
     void PPU::write_bg_palette(uint8_t value) {
@@ -631,13 +725,6 @@ namespace GB {
 
     uint8_t PPU::read_obj_palette() const { return obj_cram[obj_palette_select & 0x3F]; }
 
-    void PPU::instant_dma(uint8_t address) {
-        uint16_t addr = address << 8;
-        for (int i = 0; i < 160; ++i) {
-            oam[i] = core->bus.read(addr + i);
-        }
-    }
-
     void PPU::set_stat(uint8_t flags, bool value) {
         if (value) {
             status |= flags;
@@ -695,7 +782,7 @@ namespace GB {
                 final_pixel = bg_pixel;
             }
 
-            bg_color_table[(line_y * LCD_WIDTH) + line_x] =
+            bg_color_table[line_x] =
                 final_pixel | (static_cast<uint16_t>(bg_fifo.pixel_attribute()) << 8);
 
             if (core->bus.is_compatibility_mode()) {
@@ -756,7 +843,6 @@ namespace GB {
             }
 
             int32_t adjusted_x = static_cast<int32_t>(object.x) - 8;
-            size_t framebuffer_line_y = line_y * LCD_WIDTH;
 
             for (int x = 0; x < 8; ++x) {
                 size_t framebuffer_line_x = adjusted_x + x;
@@ -778,10 +864,8 @@ namespace GB {
                         continue;
                     }
 
-                    uint16_t bg_pixel =
-                        bg_color_table[framebuffer_line_y + framebuffer_line_x] & 0xFF;
-                    uint16_t bg_attribute =
-                        bg_color_table[framebuffer_line_y + framebuffer_line_x] >> 8;
+                    uint16_t bg_pixel = bg_color_table[framebuffer_line_x] & 0xFF;
+                    uint16_t bg_attribute = bg_color_table[framebuffer_line_x] >> 8;
 
                     bool bg_priority = bg_attribute & PRIORITY_BIT;
                     bool oam_priority = object.attributes & PRIORITY_BIT;
@@ -866,6 +950,11 @@ namespace GB {
 
     void PPU::set_mode(uint8_t mode) {
         mode &= 0x3;
+
+        if (mode == HBLANK && (status & 0x3) != HBLANK) {
+            core->dma.on_hblank();
+        }
+
         status &= ~0x3;
         status |= mode;
     }
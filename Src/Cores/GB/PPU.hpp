@@ -21,10 +21,14 @@
 #include <array>
 #include <cinttypes>
 #include <span>
+#include <vector>
 
 namespace GB {
     class Core;
     class PPU;
+    class StateArchive;
+
+    constexpr size_t FRAMEBUFFER_SIZE = LCD_WIDTH * LCD_HEIGHT * FRAMEBUFFER_COLOR_CHANNELS;
 
     constexpr uint8_t HBLANK = 0x0;
     constexpr uint8_t VBLANK = 0x1;
@@ -123,7 +127,7 @@ namespace GB {
     public:
         PPU(Core *core);
 
-        std::span<uint8_t, LCD_WIDTH * LCD_HEIGHT * 4> framebuffer();
+        std::span<uint8_t, FRAMEBUFFER_SIZE> framebuffer();
 
         void reset();
         void set_post_boot_state();
@@ -132,12 +136,27 @@ namespace GB {
 
         void step(int32_t accumulated_cycles);
 
+        // Skips pixel output but keeps modes, LY and interrupts on the same schedule. Disabling
+        // also releases the framebuffers.
+        void set_render_enabled(bool enabled);
+        // Same as disabling rendering while set, but the framebuffers are kept along with
+        // the last completed frame. For frames that are emulated but never shown.
+        void set_frame_skip(bool skip);
+
+        // Heap memory held by the framebuffers
+        size_t allocated_bytes() const;
+
+        // Framebuffers are included while rendering is enabled
+        void serialize(StateArchive &archive);
+
         void write_register(uint8_t reg, uint8_t value);
         uint8_t read_register(uint8_t reg) const;
 
         void write_vram(uint16_t address, uint8_t value);
+        void write_vram_block(uint16_t address, std::span<const uint8_t> data);
         uint8_t read_vram(uint16_t address) const;
         void write_oam(uint16_t address, uint8_t value);
+        void write_oam_block(std::span<const uint8_t> data);
         uint8_t read_oam(uint16_t address) const;
 
     private:
@@ -146,11 +165,11 @@ namespace GB {
         void write_obj_palette(uint8_t value);
         uint8_t read_obj_palette() const;
 
-        void instant_dma(uint8_t address);
 
         void set_stat(uint8_t flags, bool value);
         bool stat_any() const;
 
+        void allocate_framebuffers();
         void render_scanline();
         void render_objects();
         void plot_cgb_pixel(uint8_t x_pos, uint8_t final_pixel, uint8_t palette, bool is_obj);
@@ -164,6 +183,8 @@ namespace GB {
 
         bool window_draw_flag = false;
         bool previously_disabled = false;
+        bool render_enabled = true;
+        bool frame_skip = false;
 
         uint8_t num_obj_on_scanline = 0;
         uint8_t line_x = 0;
@@ -200,9 +221,12 @@ namespace GB {
         std::array<uint8_t, 256> oam{};
         std::array<Object, 10> objects_on_scanline{};
 
-        std::array<uint16_t, LCD_WIDTH * LCD_HEIGHT> bg_color_table{};
-        std::array<uint8_t, LCD_WIDTH * LCD_HEIGHT * 4> internal_framebuffer{};
-        std::array<uint8_t, LCD_WIDTH * LCD_HEIGHT * 4> framebuffer_complete{};
+        // Objects are mixed at the end of each line, only that line's BG pixels are needed
+        std::array<uint16_t, LCD_WIDTH> bg_color_table{};
+
+        // Allocated on first use, a core that never renders keeps them empty
+        std::vector<uint8_t> internal_framebuffer{};
+        std::vector<uint8_t> framebuffer_complete{};
 
         Core *core;
 
@@ -17,6 +17,7 @@
 */
 
 #include "Pad.hpp"
+#include "State.hpp"
 
 namespace GB {
     void Gamepad::reset() {
@@ -111,4 +112,6 @@ namespace GB {
             return dpad;
         }
     }
+
+    void Gamepad::serialize(StateArchive &archive) { archive(dpad, action, mode); }
 }
\ No newline at end of file
@@ -20,6 +20,8 @@
 #include <cinttypes>
 
 namespace GB {
+    class StateArchive;
+
     enum class PadButton { Left, Right, Up, Down, A, B, Select, Start };
 
     class Gamepad {
@@ -29,6 +31,7 @@ namespace GB {
         void set_pad_state(PadButton btn, bool pressed);
         void select_button_mode(uint8_t value);
         uint8_t get_pad_state();
+        void serialize(StateArchive &archive);
 
     private:
         uint8_t dpad = 0xFF, action = 0xFF, mode = 0;
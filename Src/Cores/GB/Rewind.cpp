@@ -0,0 +1,309 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Rewind.hpp"
+#include "Core.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace GB {
+    // Zero gaps shorter than this stay inside a literal, a new pair of counts costs more
+    constexpr size_t MIN_ZERO_RUN = 4;
+
+    static void write_count(std::vector<uint8_t> &out, size_t value) {
+        while (value >= 0x80) {
+            out.push_back(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    static bool read_count(std::span<const uint8_t> in, size_t &offset, size_t &value) {
+        value = 0;
+
+        for (int32_t shift = 0; shift < 64 && offset < in.size(); shift += 7) {
+            uint8_t byte = in[offset++];
+            value |= static_cast<size_t>(byte & 0x7F) << shift;
+
+            if (!(byte & 0x80)) {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void encode_delta(std::span<const uint8_t> a, std::span<const uint8_t> b,
+                      std::vector<uint8_t> &out) {
+        out.clear();
+
+        const size_t size = a.size();
+        const bool has_base = !b.empty();
+
+        auto byte_at = [&](size_t i) -> uint8_t { return has_base ? a[i] ^ b[i] : a[i]; };
+        auto word_at = [&](size_t i) {
+            uint64_t x = 0, y = 0;
+            std::memcpy(&x, a.data() + i, sizeof(x));
+
+            if (has_base) {
+                std::memcpy(&y, b.data() + i, sizeof(y));
+            }
+
+            return x ^ y;
+        };
+
+        size_t i = 0;
+
+        while (i < size) {
+            size_t run_start = i;
+
+            while (i + 8 <= size && word_at(i) == 0) {
+                i += 8;
+            }
+
+            while (i < size && byte_at(i) == 0) {
+                ++i;
+            }
+
+            size_t literal_start = i;
+            size_t zeros = 0;
+
+            while (i < size) {
+                if (byte_at(i) != 0) {
+                    zeros = 0;
+                } else if (++zeros == MIN_ZERO_RUN) {
+                    i -= MIN_ZERO_RUN - 1;
+                    break;
+                }
+
+                ++i;
+            }
+
+            write_count(out, literal_start - run_start);
+            write_count(out, i - literal_start);
+
+            size_t offset = out.size();
+            out.resize(offset + (i - literal_start));
+
+            for (size_t j = literal_start; j < i; ++j) {
+                out[offset++] = byte_at(j);
+            }
+        }
+    }
+
+    bool apply_delta(std::span<const uint8_t> delta, std::span<uint8_t> out) {
+        size_t in = 0, position = 0;
+
+        while (in < delta.size()) {
+            size_t zeros = 0, literal = 0;
+
+            if (!read_count(delta, in, zeros) || !read_count(delta, in, literal)) {
+                return false;
+            }
+
+            if (zeros > out.size() - position) {
+                return false;
+            }
+
+            position += zeros;
+
+            if (literal > out.size() - position || literal > delta.size() - in) {
+                return false;
+            }
+
+            for (size_t i = 0; i < literal; ++i) {
+                out[position + i] ^= delta[in + i];
+            }
+
+            position += literal;
+            in += literal;
+        }
+
+        return true;
+    }
+
+    RewindBuffer::RewindBuffer() : thread(&RewindBuffer::run, this) {}
+
+    RewindBuffer::~RewindBuffer() {
+        {
+            std::lock_guard lock(mutex);
+            quit = true;
+        }
+
+        wake.notify_one();
+        thread.join();
+    }
+
+    void RewindBuffer::configure(const RewindSettings &new_settings) {
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [this] { return !encoding; });
+
+        settings = new_settings;
+        settings.max_frames = std::max(settings.max_frames, 2);
+        settings.keyframe_interval = std::max(settings.keyframe_interval, 1);
+        reset_history();
+    }
+
+    void RewindBuffer::clear() {
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [this] { return !encoding; });
+        reset_history();
+    }
+
+    void RewindBuffer::capture(Core &core) {
+        staged.resize(core.state_size());
+
+        if (!core.save_state(staged)) {
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            // A state the helper thread has not picked up yet is replaced by this one
+            pending.swap(staged);
+            has_pending = true;
+        }
+
+        wake.notify_one();
+    }
+
+    bool RewindBuffer::rewind(Core &core) {
+        {
+            std::unique_lock lock(mutex);
+            idle.wait(lock, [this] { return !has_pending && !encoding; });
+
+            if (snapshots.size() < 2) {
+                return false;
+            }
+
+            const auto &newest = snapshots.back();
+            used -= newest.data.size();
+
+            // Later deltas can no longer refer to the keyframe the helper thread holds
+            if (newest.keyframe) {
+                --keyframes;
+                need_keyframe = true;
+            } else {
+                --since_keyframe;
+            }
+
+            snapshots.pop_back();
+
+            const auto &target = snapshots.back();
+            auto key = std::find_if(snapshots.rbegin(), snapshots.rend(),
+                                    [](const Snapshot &snapshot) { return snapshot.keyframe; });
+
+            restored.assign(key->state_size, 0);
+
+            if (!apply_delta(key->data, restored) ||
+                (!target.keyframe && !apply_delta(target.data, restored))) {
+                return false;
+            }
+        }
+
+        return core.load_state(restored);
+    }
+
+    size_t RewindBuffer::snapshot_count() {
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [this] { return !has_pending && !encoding; });
+        return snapshots.size();
+    }
+
+    size_t RewindBuffer::memory_used() {
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [this] { return !has_pending && !encoding; });
+        return used;
+    }
+
+    void RewindBuffer::run() {
+        std::unique_lock lock(mutex);
+
+        while (true) {
+            wake.wait(lock, [this] { return has_pending || quit; });
+
+            // Snapshots are only kept in memory, there is nothing to finish
+            if (quit) {
+                break;
+            }
+
+            working.swap(pending);
+            has_pending = false;
+            encoding = true;
+
+            bool make_keyframe = need_keyframe || working.size() != keyframe.size() ||
+                                 since_keyframe + 1 >= settings.keyframe_interval;
+
+            lock.unlock();
+
+            if (make_keyframe) {
+                keyframe.assign(working.begin(), working.end());
+                encode_delta(working, {}, encoded);
+            } else {
+                encode_delta(working, keyframe, encoded);
+            }
+
+            Snapshot snapshot{std::vector<uint8_t>(encoded.begin(), encoded.end()),
+                              working.size(), make_keyframe};
+
+            lock.lock();
+
+            used += snapshot.data.size();
+            snapshots.push_back(std::move(snapshot));
+
+            if (make_keyframe) {
+                ++keyframes;
+                since_keyframe = 0;
+                need_keyframe = false;
+            } else {
+                ++since_keyframe;
+            }
+
+            trim();
+
+            encoding = false;
+            idle.notify_all();
+        }
+    }
+
+    void RewindBuffer::reset_history() {
+        has_pending = false;
+        snapshots.clear();
+        keyframes = 0;
+        used = 0;
+        since_keyframe = 0;
+        need_keyframe = true;
+    }
+
+    void RewindBuffer::trim() {
+        auto over_limit = [this] {
+            return snapshots.size() > static_cast<size_t>(settings.max_frames) ||
+                   used > settings.memory_budget;
+        };
+
+        // The newest keyframe stays so the snapshots after it can still be decoded
+        while (keyframes > 1 && over_limit()) {
+            do {
+                keyframes -= snapshots.front().keyframe ? 1 : 0;
+                used -= snapshots.front().data.size();
+                snapshots.pop_front();
+            } while (!snapshots.empty() && !snapshots.front().keyframe);
+        }
+    }
+}
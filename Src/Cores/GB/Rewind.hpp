@@ -0,0 +1,107 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cinttypes>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace GB {
+    class Core;
+
+    struct RewindSettings {
+        // Compressed snapshots only, the few uncompressed working buffers are not counted
+        size_t memory_budget = 128 * 1024 * 1024;
+        int32_t max_frames = 60 * 30;
+        int32_t keyframe_interval = 60;
+    };
+
+    // Zero runs and literals of a ^ b, b may be empty to encode a as is
+    void encode_delta(std::span<const uint8_t> a, std::span<const uint8_t> b,
+                      std::vector<uint8_t> &out);
+    // XORs an encoded delta into out, false when it does not fit
+    bool apply_delta(std::span<const uint8_t> delta, std::span<uint8_t> out);
+
+    // Keeps a state per captured frame to step back through. Each snapshot is stored as the
+    // run-length coded XOR against the last keyframe, a full state taken every
+    // keyframe_interval snapshots. The emulation thread only saves the state into a buffer,
+    // the delta and compression run on a helper thread. When that thread falls behind the
+    // older of two waiting states is dropped, so rewinding may skip a frame rather than the
+    // emulation slowing down. The oldest keyframe and its deltas go once either limit is hit.
+    class RewindBuffer {
+    public:
+        RewindBuffer();
+        ~RewindBuffer();
+        RewindBuffer(const RewindBuffer &) = delete;
+        RewindBuffer(RewindBuffer &&) = delete;
+        RewindBuffer &operator=(const RewindBuffer &) = delete;
+        RewindBuffer &operator=(RewindBuffer &&) = delete;
+
+        // Both drop every snapshot
+        void configure(const RewindSettings &new_settings);
+        void clear();
+
+        // Call after each frame, the newest snapshot is taken to be the current state
+        void capture(Core &core);
+        // Drops the newest snapshot and loads the one before it into core, false when there is
+        // nothing older left
+        bool rewind(Core &core);
+
+        size_t snapshot_count();
+        size_t memory_used();
+
+    private:
+        struct Snapshot {
+            std::vector<uint8_t> data;
+            size_t state_size = 0;
+            bool keyframe = false;
+        };
+
+        void run();
+        void reset_history();
+        void trim();
+
+        RewindSettings settings{};
+
+        // Emulation thread
+        std::vector<uint8_t> staged{};
+        std::vector<uint8_t> restored{};
+
+        std::mutex mutex;
+        std::condition_variable wake, idle;
+        std::vector<uint8_t> pending{};
+        bool has_pending = false, encoding = false, quit = false;
+
+        std::deque<Snapshot> snapshots{};
+        size_t keyframes = 0;
+        size_t used = 0;
+        int32_t since_keyframe = 0;
+        bool need_keyframe = true;
+
+        // Helper thread
+        std::vector<uint8_t> working{};
+        std::vector<uint8_t> keyframe{};
+        std::vector<uint8_t> encoded{};
+
+        std::thread thread;
+    };
+}
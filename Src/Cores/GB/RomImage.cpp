@@ -0,0 +1,206 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "RomImage.hpp"
+#include <algorithm>
+#include <fstream>
+#include <map>
+#include <mutex>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GB {
+    constexpr size_t ROM_BANK_SIZE = 0x4000;
+    constexpr size_t MIN_ROM_SIZE = 0x8000;
+
+    static std::mutex cache_mutex;
+    static std::map<std::filesystem::path, std::weak_ptr<const RomImage>> image_cache;
+
+    // Tells a file replaced by another one apart from the old one, even with the same size and
+    // time. Windows has no inode to compare and keeps 0.
+    static uint64_t file_id(const std::filesystem::path &path) {
+#ifdef _WIN32
+        return 0;
+#else
+        struct stat info {};
+        if (::stat(path.c_str(), &info) != 0) {
+            return 0;
+        }
+
+        return static_cast<uint64_t>(info.st_ino) ^ (static_cast<uint64_t>(info.st_dev) << 32);
+#endif
+    }
+
+    RomImage::~RomImage() {
+        if (!mapping) {
+            return;
+        }
+
+#ifdef _WIN32
+        UnmapViewOfFile(mapping);
+#else
+        munmap(mapping, size);
+#endif
+    }
+
+    const std::filesystem::path &RomImage::path() const { return file_path; }
+
+    std::span<const uint8_t> RomImage::bytes() const { return {data, size}; }
+
+    size_t RomImage::file_length() const { return length; }
+
+    bool RomImage::is_mapped() const { return mapping != nullptr; }
+
+    std::shared_ptr<const RomImage> RomImage::open(const std::filesystem::path &path) {
+        std::error_code error;
+        auto canonical_path = std::filesystem::weakly_canonical(path, error);
+        if (error) {
+            return nullptr;
+        }
+
+        auto file_size = std::filesystem::file_size(canonical_path, error);
+        if (error || file_size == 0) {
+            return nullptr;
+        }
+
+        auto write_time = std::filesystem::last_write_time(canonical_path, error);
+        if (error) {
+            return nullptr;
+        }
+
+        auto id = file_id(canonical_path);
+
+        std::lock_guard lock(cache_mutex);
+        std::erase_if(image_cache, [](const auto &entry) { return entry.second.expired(); });
+
+        bool changed_in_use = false;
+        auto cached = image_cache.find(canonical_path);
+        if (cached != image_cache.end()) {
+            auto image = cached->second.lock();
+
+            if (image && image->write_time == write_time && image->length == file_size &&
+                image->id == id) {
+                return image;
+            }
+
+            // The old image stays with the cartridges using it. A file changed while in use is
+            // likely to be rewritten in place again, which a mapping would show, so it is copied.
+            changed_in_use = image != nullptr;
+        }
+
+        std::shared_ptr<RomImage> image(new RomImage());
+        image->file_path = canonical_path;
+        image->write_time = write_time;
+        image->length = file_size;
+        image->id = id;
+
+        // Mappers index whole 16 KiB banks, anything that is not made of them gets padded
+        bool whole_banks = (file_size % ROM_BANK_SIZE) == 0 && file_size >= MIN_ROM_SIZE;
+
+        if (!(whole_banks && !changed_in_use && image->map_file()) && !image->read_file()) {
+            return nullptr;
+        }
+
+        image_cache[canonical_path] = image;
+        return image;
+    }
+
+    std::shared_ptr<const RomImage> RomImage::from_memory(std::span<const uint8_t> bytes) {
+        if (bytes.empty()) {
+            return nullptr;
+        }
+
+        std::shared_ptr<RomImage> image(new RomImage());
+        image->length = bytes.size();
+
+        size_t padded = (bytes.size() + ROM_BANK_SIZE - 1) & ~(ROM_BANK_SIZE - 1);
+        image->buffer.assign(std::max(padded, MIN_ROM_SIZE), 0xFF);
+        std::copy(bytes.begin(), bytes.end(), image->buffer.begin());
+
+        image->data = image->buffer.data();
+        image->size = image->buffer.size();
+        return image;
+    }
+
+    bool RomImage::map_file() {
+#ifdef _WIN32
+        HANDLE file = CreateFileW(file_path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                                  OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (file == INVALID_HANDLE_VALUE) {
+            return false;
+        }
+
+        HANDLE section = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(file);
+        if (!section) {
+            return false;
+        }
+
+        // The view keeps the section alive on its own
+        void *view = MapViewOfFile(section, FILE_MAP_READ, 0, 0, length);
+        CloseHandle(section);
+        if (!view) {
+            return false;
+        }
+#else
+        int fd = ::open(file_path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return false;
+        }
+
+        void *view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        ::close(fd);
+        if (view == MAP_FAILED) {
+            return false;
+        }
+#endif
+
+        mapping = view;
+        data = static_cast<const uint8_t *>(view);
+        size = length;
+        return true;
+    }
+
+    bool RomImage::read_file() {
+        std::ifstream file(file_path, std::ios::binary);
+        if (!file) {
+            return false;
+        }
+
+        size_t padded = (length + ROM_BANK_SIZE - 1) & ~(ROM_BANK_SIZE - 1);
+        buffer.assign(std::max(padded, MIN_ROM_SIZE), 0xFF);
+
+        file.read(reinterpret_cast<char *>(buffer.data()), static_cast<std::streamsize>(length));
+        if (static_cast<size_t>(file.gcount()) != length) {
+            return false;
+        }
+
+        data = buffer.data();
+        size = buffer.size();
+        return true;
+    }
+}
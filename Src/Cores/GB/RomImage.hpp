@@ -0,0 +1,70 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cinttypes>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace GB {
+    // Read-only contents of a ROM file. Files are memory-mapped where possible and an image is
+    // shared by every cartridge that opens the same file while any of them is alive.
+    //
+    // A mapping is not a snapshot. Rewriting a mapped file in place changes the bytes running
+    // cartridges see, and on POSIX systems truncating it makes their next read past the new end
+    // crash with SIGBUS (Windows refuses to truncate a mapped file). Tools that replace a ROM by
+    // renaming a new file over it are safe, the old image keeps the old file. Opening a file
+    // whose size, time or inode changed gives a new image, read into memory rather than mapped
+    // when an image of the old contents is still in use.
+    class RomImage {
+    public:
+        ~RomImage();
+        RomImage(const RomImage &) = delete;
+        RomImage(RomImage &&) = delete;
+        RomImage &operator=(const RomImage &) = delete;
+        RomImage &operator=(RomImage &&) = delete;
+
+        const std::filesystem::path &path() const;
+        // Padded with 0xFF to whole 16 KiB banks (at least two) unless the file already is
+        std::span<const uint8_t> bytes() const;
+        size_t file_length() const;
+        bool is_mapped() const;
+
+        static std::shared_ptr<const RomImage> open(const std::filesystem::path &path);
+        // Copies bytes into a new image that has no path and is never shared through the cache
+        static std::shared_ptr<const RomImage> from_memory(std::span<const uint8_t> bytes);
+
+    private:
+        RomImage() = default;
+
+        bool map_file();
+        bool read_file();
+
+        std::filesystem::path file_path;
+        std::filesystem::file_time_type write_time{};
+        uint64_t id = 0;
+        const uint8_t *data = nullptr;
+        size_t size = 0;
+        size_t length = 0;
+
+        void *mapping = nullptr;
+        std::vector<uint8_t> buffer{};
+    };
+}
@@ -0,0 +1,78 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "RunAhead.hpp"
+#include "Core.hpp"
+#include <algorithm>
+
+namespace GB {
+    RunAhead::RunAhead() : frame(FRAMEBUFFER_SIZE, 0) {}
+
+    void RunAhead::set_frames(int32_t frames) {
+        ahead = std::clamp(frames, 0, MAX_RUN_AHEAD_FRAMES);
+        has_frame = false;
+    }
+
+    int32_t RunAhead::frames() const { return ahead; }
+
+    void RunAhead::prepare(Core &core) {
+        state.resize(core.state_size());
+        has_frame = false;
+    }
+
+    void RunAhead::run_frame(Core &core) {
+        has_frame = false;
+        core.run_for_frames(1);
+
+        if (ahead == 0) {
+            return;
+        }
+
+        // Same size as after prepare() unless the ROM changed
+        state.resize(core.state_size());
+
+        if (!core.save_state(state)) {
+            return;
+        }
+
+        auto audio_mode = core.audio_mode();
+        core.set_audio_mode(AudioMode::Silent);
+
+        // The frame completed last may have started drawing in the frame before, so only the
+        // last two are drawn
+        for (int32_t i = 1; i <= ahead; ++i) {
+            core.ppu.set_frame_skip(i < ahead - 1);
+            core.run_for_frames(1);
+        }
+
+        auto picture = core.ppu.framebuffer();
+        std::copy(picture.begin(), picture.end(), frame.begin());
+        has_frame = true;
+
+        core.set_audio_mode(audio_mode);
+        core.load_state(state);
+    }
+
+    std::span<const uint8_t> RunAhead::framebuffer(Core &core) {
+        if (has_frame) {
+            return frame;
+        }
+
+        return core.ppu.framebuffer();
+    }
+}
@@ -0,0 +1,54 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cinttypes>
+#include <span>
+#include <vector>
+
+namespace GB {
+    class Core;
+
+    constexpr int32_t MAX_RUN_AHEAD_FRAMES = 4;
+
+    // Hides the frames of input lag a game has internally. Each call runs the real frame with
+    // the core's audio, saves the state, runs the given number of frames further with the same
+    // input and keeps the last of their pictures, then loads the state back. The core is only
+    // ever left at the real frame, so run-ahead has no effect on what the game does.
+    class RunAhead {
+    public:
+        RunAhead();
+
+        // 0 runs frames as usual
+        void set_frames(int32_t frames);
+        int32_t frames() const;
+
+        // Sizes the state buffer for the ROM core is running so run_frame does not allocate
+        void prepare(Core &core);
+        void run_frame(Core &core);
+
+        // The picture from the frames run ahead, or the core's own when none were
+        std::span<const uint8_t> framebuffer(Core &core);
+
+    private:
+        int32_t ahead = 0;
+        bool has_frame = false;
+        std::vector<uint8_t> state{};
+        std::vector<uint8_t> frame{};
+    };
+}
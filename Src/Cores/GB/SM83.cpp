@@ -20,12 +20,13 @@
 #include "Bus.hpp"
 #include "Constants.hpp"
 #include "Core.hpp"
+#include "State.hpp"
 #include <stdexcept>
 
 #define GET_REG(R) registers[static_cast<size_t>(R)]
 
 namespace GB {
-    SM83::SM83(Core *core) : opcodes(gen_optable()), cb_opcodes(gen_cb_optable()), core(core) {
+    SM83::SM83(Core *core) : opcodes(optable()), cb_opcodes(cb_optable()), core(core) {
         if (!core) {
             throw std::invalid_argument("Core cannot be null.");
         }
@@ -33,11 +34,17 @@ namespace GB {
 
     bool SM83::stopped() const { return stopped_; }
 
+    void SM83::serialize(StateArchive &archive) {
+        archive(master_interrupt_enable_, halted_, ei_delay_, stopped_, double_speed_);
+        archive(interrupt_flag, interrupt_enable, KEY1, sp, pc, registers);
+    }
+
     bool SM83::double_speed() const { return double_speed_; }
 
     void SM83::reset(uint16_t new_pc) {
         master_interrupt_enable_ = false;
         double_speed_ = false;
+        core->timer.reschedule();
         halted_ = false;
         stopped_ = false;
         ei_delay_ = false;
@@ -155,6 +162,11 @@ namespace GB {
 
     uint8_t SM83::read(uint16_t address) {
         core->tick_subcomponents(4);
+
+        if (address < 0xFF00 && core->oam_dma.blocks_bus(core->elapsed_cycles())) {
+            return 0xFF;
+        }
+
         return core->bus.read(address);
     }
 
@@ -167,6 +179,11 @@ namespace GB {
 
     void SM83::write(uint16_t address, uint8_t value) {
         core->tick_subcomponents(4);
+
+        if (address < 0xFF00 && core->oam_dma.blocks_bus(core->elapsed_cycles())) {
+            return;
+        }
+
         core->bus.write(address, value);
     }
 
@@ -268,12 +285,14 @@ namespace GB {
     void SM83::op_stop() {
         if (core->bus.is_compatibility_mode()) {
             stopped_ = true;
+            core->timer.write_register(0x04, 0);
             return;
         }
 
         if (KEY1 & 0x1) {
             double_speed_ = !double_speed_;
             KEY1 = double_speed_ << 7;
+            core->timer.reschedule();
         }
 
         pc += 2;
@@ -1108,6 +1127,16 @@ namespace GB {
         }
     }
 
+    const std::array<SM83::opcode_function, 256> &SM83::optable() {
+        static const auto table = gen_optable();
+        return table;
+    }
+
+    const std::array<SM83::opcode_function, 256> &SM83::cb_optable() {
+        static const auto table = gen_cb_optable();
+        return table;
+    }
+
     std::array<SM83::opcode_function, 256> SM83::gen_optable() {
         constexpr int16_t NoDisplacement = 0;
         constexpr int16_t Increment = 1;
@@ -22,6 +22,7 @@
 
 namespace GB {
     class Core;
+    class StateArchive;
 
     enum class Register {
         B = 0,
@@ -60,6 +61,10 @@ namespace GB {
         void request_interrupt(uint8_t interrupt);
         void step();
 
+        uint8_t get_register(Register r) const { return registers[static_cast<uint8_t>(r)]; }
+
+        void serialize(StateArchive &archive);
+
     private:
         void service_interrupts();
 
@@ -150,6 +155,8 @@ namespace GB {
         using opcode_function = void (SM83::*)();
         static std::array<SM83::opcode_function, 256> gen_optable();
         static std::array<SM83::opcode_function, 256> gen_cb_optable();
+        static const std::array<SM83::opcode_function, 256> &optable();
+        static const std::array<SM83::opcode_function, 256> &cb_optable();
 
         bool master_interrupt_enable_ = true;
         bool halted_ = false;
@@ -163,8 +170,9 @@ namespace GB {
         uint16_t sp = 0xFFFF, pc = 0;
         std::array<uint8_t, 8> registers{};
 
-        std::array<opcode_function, 256> opcodes;
-        std::array<opcode_function, 256> cb_opcodes;
+        // Built once and shared read-only by every instance
+        const std::array<opcode_function, 256> &opcodes;
+        const std::array<opcode_function, 256> &cb_opcodes;
 
         Core *core;
 
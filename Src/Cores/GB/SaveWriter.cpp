@@ -0,0 +1,125 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "SaveWriter.hpp"
+#include "Cartridge.hpp"
+#include <fstream>
+
+namespace GB {
+    bool write_save_file(const std::filesystem::path &path, std::span<const uint8_t> data) {
+        std::filesystem::path temp_path = path;
+        temp_path += ".tmp";
+
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            if (!file) {
+                return false;
+            }
+
+            file.write(reinterpret_cast<const char *>(data.data()), data.size());
+            file.flush();
+
+            if (!file) {
+                return false;
+            }
+        }
+
+        std::error_code error{};
+        std::filesystem::rename(temp_path, path, error);
+
+        if (error) {
+            std::filesystem::remove(temp_path, error);
+            return false;
+        }
+
+        return true;
+    }
+
+    SaveWriter::SaveWriter() : thread(&SaveWriter::run, this) {}
+
+    SaveWriter::~SaveWriter() {
+        {
+            std::lock_guard lock(mutex);
+            quit = true;
+        }
+
+        wake.notify_one();
+        thread.join();
+    }
+
+    void SaveWriter::queue(Cartridge &cart) { submit(cart, false); }
+
+    void SaveWriter::flush(Cartridge &cart) {
+        submit(cart, true);
+
+        std::unique_lock lock(mutex);
+        idle.wait(lock, [this] { return !has_pending && !writing; });
+    }
+
+    void SaveWriter::submit(Cartridge &cart, bool force) {
+        if (!cart.has_battery()) {
+            return;
+        }
+
+        auto path = cart.save_path();
+
+        // The mirror only tracks one cartridge, another one starts from a full image
+        if (path != image_path) {
+            image_path = path;
+            image.clear();
+        }
+
+        if (!cart.update_save_image(image, force)) {
+            return;
+        }
+
+        {
+            std::lock_guard lock(mutex);
+            pending_path = image_path;
+            pending = image;
+            has_pending = true;
+        }
+
+        wake.notify_one();
+    }
+
+    void SaveWriter::run() {
+        std::unique_lock lock(mutex);
+
+        while (true) {
+            wake.wait(lock, [this] { return has_pending || quit; });
+
+            // Anything still pending is written out before quitting
+            if (!has_pending) {
+                break;
+            }
+
+            auto path = std::move(pending_path);
+            auto data = std::move(pending);
+            has_pending = false;
+            writing = true;
+
+            lock.unlock();
+            write_save_file(path, data);
+            lock.lock();
+
+            writing = false;
+            idle.notify_all();
+        }
+    }
+}
@@ -0,0 +1,66 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cinttypes>
+#include <condition_variable>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <vector>
+
+namespace GB {
+    class Cartridge;
+
+    // Writes to a temporary file next to path and renames it over path, so an interrupted
+    // write leaves the previous save intact
+    bool write_save_file(const std::filesystem::path &path, std::span<const uint8_t> data);
+
+    // Persists battery RAM from a background thread. The emulation thread only copies the pages
+    // written since the last save into a mirror of the file, the disk write happens off-thread.
+    class SaveWriter {
+    public:
+        SaveWriter();
+        ~SaveWriter();
+        SaveWriter(const SaveWriter &) = delete;
+        SaveWriter(SaveWriter &&) = delete;
+        SaveWriter &operator=(const SaveWriter &) = delete;
+        SaveWriter &operator=(SaveWriter &&) = delete;
+
+        // Schedules a write if the cartridge RAM changed since the last call
+        void queue(Cartridge &cart);
+        // Schedules a write regardless and waits until it is on disk
+        void flush(Cartridge &cart);
+
+    private:
+        void submit(Cartridge &cart, bool force);
+        void run();
+
+        std::filesystem::path image_path{};
+        std::vector<uint8_t> image{};
+
+        std::mutex mutex;
+        std::condition_variable wake, idle;
+        std::filesystem::path pending_path{};
+        std::vector<uint8_t> pending{};
+        bool has_pending = false, writing = false, quit = false;
+
+        std::thread thread;
+    };
+}
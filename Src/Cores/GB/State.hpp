@@ -0,0 +1,140 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <algorithm>
+#include <cinttypes>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+namespace GB {
+    constexpr uint32_t STATE_MAGIC = 0x53424342; // "BCBS"
+    constexpr uint32_t STATE_VERSION = 1;
+
+    // Leads every state, size covers the whole state including this header
+    struct StateHeader {
+        uint32_t magic = STATE_MAGIC;
+        uint32_t version = STATE_VERSION;
+        uint32_t size = 0;
+        uint16_t rom_checksum = 0;
+        uint8_t header_checksum = 0;
+        uint8_t reserved = 0;
+    };
+
+    // Walks the fields of each component in a fixed order to measure, save or load them, so
+    // a component lists its state once in serialize(). Fields are trivially copyable and copied
+    // as raw bytes, plain arrays such as VRAM and WRAM in one piece. A state can only be loaded
+    // by a build with the same layout and endianness as the one that wrote it.
+    class StateArchive {
+    public:
+        enum class Mode { Measure, Save, Load };
+
+        static StateArchive measure() { return StateArchive(Mode::Measure, nullptr, 0); }
+        static StateArchive save(std::span<uint8_t> buffer) {
+            return StateArchive(Mode::Save, buffer.data(), buffer.size());
+        }
+        static StateArchive load(std::span<const uint8_t> buffer) {
+            return StateArchive(Mode::Load, const_cast<uint8_t *>(buffer.data()), buffer.size());
+        }
+
+        Mode mode() const { return mode_; }
+        bool loading() const { return mode_ == Mode::Load; }
+        // False once a save or load ran past the end of the buffer
+        bool ok() const { return ok_; }
+        size_t offset() const { return offset_; }
+        // For values a component finds out of range while loading
+        void fail() { ok_ = false; }
+
+        template <typename... T> void operator()(T &...fields) { (field(fields), ...); }
+
+        void bytes(void *data, size_t size) {
+            if (mode_ != Mode::Measure) {
+                if (!ok_ || size > size_ - offset_) {
+                    ok_ = false;
+                    return;
+                }
+
+                if (mode_ == Mode::Save) {
+                    std::memcpy(buffer + offset_, data, size);
+                } else {
+                    std::memcpy(data, buffer + offset_, size);
+                }
+            }
+
+            offset_ += size;
+        }
+
+        void bytes(std::span<uint8_t> data) { bytes(data.data(), data.size()); }
+
+        // Same as bytes, but a load only copies the pages that differ and returns them as a
+        // mask, bit n for page n with the pages past 63 sharing bit 63. Saved memory that a
+        // load leaves as it was is then not written out again.
+        uint64_t pages(std::span<uint8_t> data, size_t page_size) {
+            if (mode_ != Mode::Load) {
+                bytes(data);
+                return 0;
+            }
+
+            if (!ok_ || data.size() > size_ - offset_) {
+                ok_ = false;
+                return 0;
+            }
+
+            uint64_t changed = 0;
+
+            for (size_t page = 0; page * page_size < data.size(); ++page) {
+                size_t start = page * page_size;
+                size_t length = std::min(page_size, data.size() - start);
+
+                if (std::memcmp(data.data() + start, buffer + offset_ + start, length) != 0) {
+                    std::memcpy(data.data() + start, buffer + offset_ + start, length);
+                    changed |= 1ull << std::min<size_t>(page, 63);
+                }
+            }
+
+            offset_ += data.size();
+            return changed;
+        }
+
+        // Passes over data a loading core has nowhere to put
+        void skip(size_t size) {
+            if (mode_ != Mode::Measure && size > size_ - offset_) {
+                ok_ = false;
+                return;
+            }
+
+            offset_ += size;
+        }
+
+    private:
+        StateArchive(Mode mode, uint8_t *buffer, size_t size)
+            : mode_(mode), buffer(buffer), size_(size) {}
+
+        template <typename T> void field(T &value) {
+            static_assert(std::is_trivially_copyable_v<T>);
+            bytes(&value, sizeof(T));
+        }
+
+        Mode mode_;
+        bool ok_ = true;
+        uint8_t *buffer = nullptr;
+        size_t size_ = 0;
+        size_t offset_ = 0;
+    };
+}
@@ -0,0 +1,171 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "TimeStretcher.hpp"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+
+namespace GB {
+    TimeStretcher::TimeStretcher() {
+        // Rising half of a Hann window, the falling half is 1 - fade_in so overlaps sum to 1
+        for (size_t i = 0; i < HOP; ++i) {
+            double phase = std::numbers::pi * static_cast<double>(i) / HOP;
+            fade_in[i] = static_cast<float>(0.5 - 0.5 * std::cos(phase));
+        }
+
+        input_buffer.reserve((WINDOW + SEARCH + static_cast<size_t>(HOP * MAX_EMULATION_SPEED)) *
+                             4);
+        overlap.resize(HOP * 2);
+    }
+
+    void TimeStretcher::reset() {
+        primed = false;
+        nominal_position = 0.0;
+        continuation = 0;
+        input_buffer.clear();
+        std::fill(overlap.begin(), overlap.end(), 0.0f);
+    }
+
+    void TimeStretcher::set_speed(float new_speed) {
+        speed_ = std::clamp(new_speed, MIN_EMULATION_SPEED, MAX_EMULATION_SPEED);
+    }
+
+    float TimeStretcher::speed() const { return speed_; }
+
+    void TimeStretcher::process(std::span<const float> input, std::vector<float> &output) {
+        if (speed_ == 1.0f && !primed) {
+            output.insert(output.end(), input.begin(), input.end());
+            return;
+        }
+
+        input_buffer.insert(input_buffer.end(), input.begin(), input.end());
+
+        if (speed_ == 1.0f) {
+            flush_to_passthrough(output);
+            return;
+        }
+
+        while (true) {
+            size_t nominal = static_cast<size_t>(nominal_position);
+
+            if (nominal + SEARCH + WINDOW > frames_buffered()) {
+                break;
+            }
+
+            size_t start = primed ? find_best_start(nominal) : nominal;
+            emit_segment(start, output);
+
+            continuation = start + HOP;
+            nominal_position += HOP * static_cast<double>(speed_);
+            primed = true;
+        }
+
+        discard_consumed();
+    }
+
+    size_t TimeStretcher::frames_buffered() const { return input_buffer.size() / 2; }
+
+    size_t TimeStretcher::find_best_start(size_t nominal) const {
+        size_t first = nominal > SEARCH ? nominal - SEARCH : 0;
+        size_t last = nominal + SEARCH;
+
+        size_t best = nominal;
+        float best_score = similarity(nominal, continuation);
+
+        for (size_t candidate = first; candidate <= last; candidate += DECIMATION) {
+            float score = similarity(candidate, continuation);
+
+            if (score > best_score) {
+                best_score = score;
+                best = candidate;
+            }
+        }
+
+        // Refine the coarse match at full resolution
+        size_t refine_first = best > first + DECIMATION ? best - DECIMATION : first;
+        size_t refine_last = std::min(best + DECIMATION, last);
+
+        for (size_t candidate = refine_first; candidate <= refine_last; ++candidate) {
+            float score = similarity(candidate, continuation);
+
+            if (score > best_score) {
+                best_score = score;
+                best = candidate;
+            }
+        }
+
+        return best;
+    }
+
+    float TimeStretcher::similarity(size_t candidate, size_t target) const {
+        const float *a = &input_buffer[candidate * 2];
+        const float *b = &input_buffer[target * 2];
+        float correlation = 0.0f, energy = 1e-9f;
+
+        for (size_t i = 0; i < HOP * 2; i += DECIMATION * 2) {
+            correlation += a[i] * b[i] + a[i + 1] * b[i + 1];
+            energy += a[i] * a[i] + a[i + 1] * a[i + 1];
+        }
+
+        return correlation / std::sqrt(energy);
+    }
+
+    void TimeStretcher::emit_segment(size_t start, std::vector<float> &output) {
+        const float *segment = &input_buffer[start * 2];
+        const float *tail = &input_buffer[(start + HOP) * 2];
+
+        for (size_t i = 0; i < HOP; ++i) {
+            output.push_back(overlap[i * 2] + segment[i * 2] * fade_in[i]);
+            output.push_back(overlap[i * 2 + 1] + segment[i * 2 + 1] * fade_in[i]);
+
+            overlap[i * 2] = tail[i * 2] * (1.0f - fade_in[i]);
+            overlap[i * 2 + 1] = tail[i * 2 + 1] * (1.0f - fade_in[i]);
+        }
+    }
+
+    void TimeStretcher::flush_to_passthrough(std::vector<float> &output) {
+        // The continuation picks up exactly where the last segment left off, so crossfading
+        // into it and then copying the rest returns to passthrough without a seam
+        const float *segment = &input_buffer[continuation * 2];
+
+        for (size_t i = 0; i < HOP; ++i) {
+            output.push_back(overlap[i * 2] + segment[i * 2] * fade_in[i]);
+            output.push_back(overlap[i * 2 + 1] + segment[i * 2 + 1] * fade_in[i]);
+        }
+
+        auto remaining = input_buffer.begin() + static_cast<ptrdiff_t>((continuation + HOP) * 2);
+        output.insert(output.end(), remaining, input_buffer.end());
+
+        reset();
+    }
+
+    void TimeStretcher::discard_consumed() {
+        size_t nominal = static_cast<size_t>(nominal_position);
+        size_t needed = std::min(continuation, nominal > SEARCH ? nominal - SEARCH : 0);
+
+        if (needed < WINDOW) {
+            return;
+        }
+
+        input_buffer.erase(input_buffer.begin(),
+                           input_buffer.begin() + static_cast<ptrdiff_t>(needed * 2));
+        nominal_position -= static_cast<double>(needed);
+        continuation -= needed;
+    }
+}
@@ -0,0 +1,65 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <array>
+#include <cinttypes>
+#include <span>
+#include <vector>
+
+namespace GB {
+    constexpr float MIN_EMULATION_SPEED = 0.25f;
+    constexpr float MAX_EMULATION_SPEED = 8.0f;
+
+    // WSOLA time-stretcher for interleaved stereo frames, keeps pitch when the emulation
+    // speed changes. The similarity search is decimated and bounded so the cost per output
+    // segment is constant regardless of speed.
+    class TimeStretcher {
+    public:
+        static constexpr size_t WINDOW = 1024;
+        static constexpr size_t HOP = WINDOW / 2;
+        static constexpr size_t SEARCH = 256;
+        static constexpr size_t DECIMATION = 4;
+
+        TimeStretcher();
+
+        void reset();
+        void set_speed(float new_speed);
+        float speed() const;
+
+        // Appends the stretched frames to output, at 1.0x the input is passed through
+        void process(std::span<const float> input, std::vector<float> &output);
+
+    private:
+        size_t frames_buffered() const;
+        size_t find_best_start(size_t nominal) const;
+        float similarity(size_t candidate, size_t target) const;
+        void emit_segment(size_t start, std::vector<float> &output);
+        void flush_to_passthrough(std::vector<float> &output);
+        void discard_consumed();
+
+        float speed_ = 1.0f;
+        bool primed = false;
+        double nominal_position = 0.0;
+        size_t continuation = 0;
+
+        std::array<float, HOP> fade_in{};
+        std::vector<float> input_buffer{};
+        std::vector<float> overlap{};
+    };
+}
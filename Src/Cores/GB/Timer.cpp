@@ -18,20 +18,16 @@
 
 #include "Timer.hpp"
 #include "Core.hpp"
+#include "State.hpp"
+#include <algorithm>
 #include <array>
 #include <stdexcept>
 
 namespace GB {
-    constexpr bool EdgeFell(uint16_t previous, uint16_t next, uint16_t mask) {
-        return (previous & mask) && (!(next & mask));
-    }
-
     Timer::Timer(Core *core) : core(core) {
         if (!core) {
             throw std::invalid_argument("Core cannot be null.");
         }
-
-        reset();
     }
 
     void Timer::write_register(uint8_t reg, uint8_t value) {
@@ -70,47 +66,102 @@ namespace GB {
     }
 
     void Timer::reset() {
-        div_cycles = 0xAB00;
+        div_base = 0xAB00;
+        div_base_time = core->elapsed_cycles();
         tima = 0;
         tma = 0;
-        set_tac(0xF8);
+        tac = 0xF8;
+        tac_rate = 512;
+        reschedule();
     }
 
     void Timer::set_tac(uint8_t rate) {
         static constexpr std::array<uint16_t, 4> tac_table = {512, 8, 32, 128};
 
+        uint16_t div = div_now();
+        bool was_high = timer_enabled() && (div & tac_rate);
+
         tac_rate = tac_table[rate & 0x3];
         tac = rate;
+
+        // Switching the selected bit or disabling the timer can produce a falling edge
+        if (was_high && !(timer_enabled() && (div & tac_rate))) {
+            increment_tima();
+        }
+
+        reschedule();
     }
 
-    void Timer::reset_div() { change_div(0); }
+    void Timer::reset_div() {
+        uint16_t div = div_now();
 
-    uint8_t Timer::read_div() { return div_cycles >> 8; }
+        if (div & frame_sequencer_mask()) {
+            core->apu.step_frame_sequencer();
+        }
 
-    void Timer::update(int32_t cycles) {
-        if (core->cpu.stopped()) {
-            change_div(0);
-        } else {
-            change_div(div_cycles + cycles);
+        if (timer_enabled() && (div & tac_rate)) {
+            increment_tima();
         }
+
+        div_base = 0;
+        div_base_time = core->elapsed_cycles();
+        reschedule();
     }
 
-    bool Timer::timer_enabled() const { return tac & 0b100; }
+    uint8_t Timer::read_div() { return div_now() >> 8; }
 
-    void Timer::change_div(uint16_t new_div) {
-        if (EdgeFell(div_cycles >> 8, new_div >> 8,
-                     core->cpu.double_speed() ? 0b100000 : 0b10000)) {
+    uint16_t Timer::div_now() const {
+        return static_cast<uint16_t>(div_base + (core->elapsed_cycles() - div_base_time));
+    }
+
+    uint16_t Timer::frame_sequencer_mask() const {
+        return core->cpu.double_speed() ? 0x2000 : 0x1000;
+    }
+
+    void Timer::update() {
+        uint64_t now = core->elapsed_cycles();
+
+        while (next_frame_sequencer <= now) {
             core->apu.step_frame_sequencer();
+            next_frame_sequencer += frame_sequencer_mask() * 2;
         }
 
-        if (timer_enabled() && EdgeFell(div_cycles, new_div, tac_rate)) {
-            ++tima;
-            if (tima == 0) {
-                tima = tma;
-                core->cpu.request_interrupt(INT_TIMER_BIT);
-            }
+        while (next_tima <= now) {
+            increment_tima();
+            next_tima += tac_rate * 2;
         }
 
-        div_cycles = new_div;
+        next_event_ = std::min(next_tima, next_frame_sequencer);
+    }
+
+    void Timer::reschedule() {
+        uint64_t now = core->elapsed_cycles();
+        uint16_t div = div_now();
+
+        // A bit falls each time DIV reaches a multiple of twice its value
+        auto next_fall = [&](uint16_t mask) {
+            uint32_t period = mask * 2;
+            uint32_t remaining = period - (div & (period - 1));
+            return now + remaining;
+        };
+
+        next_frame_sequencer = next_fall(frame_sequencer_mask());
+        next_tima = timer_enabled() ? next_fall(tac_rate) : UINT64_MAX;
+        next_event_ = std::min(next_tima, next_frame_sequencer);
+    }
+
+    void Timer::serialize(StateArchive &archive) {
+        archive(tima, tma, tac, tac_rate, div_base, div_base_time);
+        archive(next_tima, next_frame_sequencer, next_event_);
+    }
+
+    bool Timer::timer_enabled() const { return tac & 0b100; }
+
+    void Timer::increment_tima() {
+        ++tima;
+        if (tima == 0) {
+            tima = tma;
+            core->cpu.request_interrupt(INT_TIMER_BIT);
+        }
     }
 }
@@ -21,7 +21,11 @@
 
 namespace GB {
     class Core;
+    class StateArchive;
 
+    // DIV is reconstructed from the core clock on demand. Instead of checking for falling
+    // edges every M-cycle the timer computes when the next TIMA increment and frame
+    // sequencer step will happen and the core only calls update() once that time is reached.
     class Timer {
     public:
         Timer(Core *core);
@@ -30,19 +34,31 @@ namespace GB {
         void write_register(uint8_t reg, uint8_t value);
         uint8_t read_register(uint8_t reg);
         void reset();
-        void update(int32_t cycles);
+        void update();
+        void reschedule();
+        void serialize(StateArchive &archive);
+
+        uint64_t next_event() const { return next_event_; }
 
     private:
         void set_tac(uint8_t rate);
         void reset_div();
         uint8_t read_div();
-        void change_div(uint16_t new_div);
+        uint16_t div_now() const;
+        uint16_t frame_sequencer_mask() const;
+        void increment_tima();
 
         Core *core;
         uint8_t tima = 0;
         uint8_t tma = 0;
         uint8_t tac = 0;
         uint16_t tac_rate = 0;
-        uint16_t div_cycles = 0;
+
+        uint16_t div_base = 0;
+        uint64_t div_base_time = 0;
+
+        uint64_t next_tima = 0;
+        uint64_t next_frame_sequencer = 0;
+        uint64_t next_event_ = 0;
     };
 }
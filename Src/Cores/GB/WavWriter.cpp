@@ -0,0 +1,103 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "WavWriter.hpp"
+#include <array>
+#include <bit>
+
+namespace GB {
+    constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 3;
+    constexpr uint32_t HEADER_SIZE = 44;
+
+    static void put_u16(std::ofstream &file, uint16_t value) {
+        std::array<char, 2> bytes{static_cast<char>(value), static_cast<char>(value >> 8)};
+        file.write(bytes.data(), bytes.size());
+    }
+
+    static void put_u32(std::ofstream &file, uint32_t value) {
+        std::array<char, 4> bytes{static_cast<char>(value), static_cast<char>(value >> 8),
+                                  static_cast<char>(value >> 16), static_cast<char>(value >> 24)};
+        file.write(bytes.data(), bytes.size());
+    }
+
+    WavWriter::~WavWriter() { close(); }
+
+    bool WavWriter::open(std::filesystem::path path, uint16_t channels, uint32_t sample_rate) {
+        close();
+
+        file.open(path, std::ios::binary | std::ios::trunc);
+        channel_count = channels;
+        rate = sample_rate;
+        data_bytes = 0;
+
+        if (!file) {
+            return false;
+        }
+
+        write_header();
+        return true;
+    }
+
+    void WavWriter::write(std::span<const float> samples) {
+        if (!file) {
+            return;
+        }
+
+        if constexpr (std::endian::native == std::endian::little) {
+            file.write(reinterpret_cast<const char *>(samples.data()), samples.size_bytes());
+        } else {
+            for (float sample : samples) {
+                put_u32(file, std::bit_cast<uint32_t>(sample));
+            }
+        }
+
+        data_bytes += static_cast<uint32_t>(samples.size_bytes());
+    }
+
+    void WavWriter::close() {
+        if (!file.is_open()) {
+            return;
+        }
+
+        file.seekp(0);
+        write_header();
+        file.close();
+    }
+
+    bool WavWriter::is_open() const { return file.is_open(); }
+
+    void WavWriter::write_header() {
+        uint16_t block_align = channel_count * sizeof(float);
+
+        file.write("RIFF", 4);
+        put_u32(file, HEADER_SIZE - 8 + data_bytes);
+        file.write("WAVE", 4);
+
+        file.write("fmt ", 4);
+        put_u32(file, 16);
+        put_u16(file, WAVE_FORMAT_IEEE_FLOAT);
+        put_u16(file, channel_count);
+        put_u32(file, rate);
+        put_u32(file, rate * block_align);
+        put_u16(file, block_align);
+        put_u16(file, 32);
+
+        file.write("data", 4);
+        put_u32(file, data_bytes);
+    }
+}
@@ -0,0 +1,49 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <cinttypes>
+#include <filesystem>
+#include <fstream>
+#include <span>
+
+namespace GB {
+    // Streams 32-bit float PCM, the header sizes are patched when the file is closed
+    class WavWriter {
+    public:
+        WavWriter() = default;
+        ~WavWriter();
+        WavWriter(const WavWriter &) = delete;
+        WavWriter(WavWriter &&other) = delete;
+        WavWriter &operator=(const WavWriter &) = delete;
+        WavWriter &operator=(WavWriter &&other) = delete;
+
+        bool open(std::filesystem::path path, uint16_t channels, uint32_t sample_rate);
+        void write(std::span<const float> samples);
+        void close();
+        bool is_open() const;
+
+    private:
+        void write_header();
+
+        std::ofstream file;
+        uint16_t channel_count = 0;
+        uint32_t rate = 0;
+        uint32_t data_bytes = 0;
+    };
+}
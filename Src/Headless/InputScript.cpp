@@ -0,0 +1,106 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "InputScript.hpp"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+namespace Headless {
+    constexpr std::array<std::string_view, 8> BUTTON_NAMES{
+        "left", "right", "up", "down", "a", "b", "select", "start",
+    };
+
+    static std::optional<GB::PadButton> parse_button(std::string name) {
+        std::transform(name.begin(), name.end(), name.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+
+        auto it = std::find(BUTTON_NAMES.begin(), BUTTON_NAMES.end(), name);
+
+        if (it == BUTTON_NAMES.end()) {
+            return std::nullopt;
+        }
+
+        return static_cast<GB::PadButton>(it - BUTTON_NAMES.begin());
+    }
+
+    std::optional<InputScript> InputScript::from_file(const std::filesystem::path &path) {
+        std::ifstream file(path);
+
+        if (!file) {
+            std::fprintf(stderr, "Unable to open '%s'\n", path.string().c_str());
+            return std::nullopt;
+        }
+
+        InputScript script{};
+        std::string line;
+
+        for (int32_t line_number = 1; std::getline(file, line); ++line_number) {
+            line = line.substr(0, line.find('#'));
+
+            std::istringstream tokens(line);
+            std::string token;
+
+            if (!(tokens >> token)) {
+                continue;
+            }
+
+            InputEvent event{};
+            auto [end, error] =
+                std::from_chars(token.data(), token.data() + token.size(), event.frame);
+
+            if (error != std::errc{} || end != token.data() + token.size() || event.frame < 0) {
+                std::fprintf(stderr, "%s:%d: invalid frame '%s'\n", path.string().c_str(),
+                             line_number, token.c_str());
+                return std::nullopt;
+            }
+
+            while (tokens >> token) {
+                auto button = parse_button(token);
+
+                if (!button) {
+                    std::fprintf(stderr, "%s:%d: unknown button '%s'\n", path.string().c_str(),
+                                 line_number, token.c_str());
+                    return std::nullopt;
+                }
+
+                event.buttons[static_cast<size_t>(*button)] = true;
+            }
+
+            script.events.push_back(event);
+        }
+
+        std::stable_sort(script.events.begin(), script.events.end(),
+                         [](const auto &a, const auto &b) { return a.frame < b.frame; });
+
+        return script;
+    }
+
+    const ButtonState &InputScript::buttons_for_frame(int32_t frame) {
+        while (next_event < events.size() && events[next_event].frame <= frame) {
+            current = events[next_event++].buttons;
+        }
+
+        return current;
+    }
+}
@@ -0,0 +1,51 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "Cores/GB/Pad.hpp"
+#include <array>
+#include <cinttypes>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+namespace Headless {
+    // Buttons indexed by GB::PadButton
+    using ButtonState = std::array<bool, 8>;
+
+    struct InputEvent {
+        int32_t frame = 0;
+        ButtonState buttons{};
+    };
+
+    // Text file with one "<frame> [button...]" line per change, buttons are named left, right,
+    // up, down, a, b, select and start. A line without buttons releases everything, each state
+    // is held until the next line and # starts a comment.
+    class InputScript {
+    public:
+        static std::optional<InputScript> from_file(const std::filesystem::path &path);
+
+        // Frames have to be asked for in increasing order
+        const ButtonState &buttons_for_frame(int32_t frame);
+
+    private:
+        std::vector<InputEvent> events{};
+        size_t next_event = 0;
+        ButtonState current{};
+    };
+}
@@ -0,0 +1,234 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+
+#include "Cores/GB/AudioRecorder.hpp"
+#include "Cores/GB/Constants.hpp"
+#include "Cores/GB/Core.hpp"
+#include "InputScript.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+struct Options {
+    std::filesystem::path rom_path;
+    std::filesystem::path wav_path;
+    std::filesystem::path input_path;
+    std::filesystem::path screenshot_path;
+    std::filesystem::path hashes_path;
+    int32_t frames = 60 * 60;
+    int32_t sample_rate = 48000;
+    int32_t track = 0;
+    bool stems = false;
+};
+
+void print_usage() {
+    std::puts("usage: BigComBoyHeadless <rom> [options]\n"
+              "  --frames <n>        number of frames to emulate (default 3600)\n"
+              "  --wav <path>        record the stereo mix to a WAV file\n"
+              "  --stems             also record one WAV per channel next to the mix\n"
+              "  --rate <hz>         sample rate of the recording (default 48000)\n"
+              "  --track <n>         track to play when the file is a GBS sound file\n"
+              "  --input <path>      replay buttons from a script of frame and button lines\n"
+              "  --screenshot <path> write the final frame as a binary PPM image\n"
+              "  --hashes <path>     write a hash of every frame, one line per frame");
+}
+
+std::optional<Options> parse_arguments(int argc, char *argv[]) {
+    Options options{};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--frames" && has_value) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (arg == "--wav" && has_value) {
+            options.wav_path = argv[++i];
+        } else if (arg == "--rate" && has_value) {
+            options.sample_rate = std::atoi(argv[++i]);
+        } else if (arg == "--track" && has_value) {
+            options.track = std::atoi(argv[++i]);
+        } else if (arg == "--input" && has_value) {
+            options.input_path = argv[++i];
+        } else if (arg == "--screenshot" && has_value) {
+            options.screenshot_path = argv[++i];
+        } else if (arg == "--hashes" && has_value) {
+            options.hashes_path = argv[++i];
+        } else if (arg == "--stems") {
+            options.stems = true;
+        } else if (!arg.starts_with("--") && options.rom_path.empty()) {
+            options.rom_path = arg;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    if (options.rom_path.empty() || options.frames <= 0 || options.sample_rate <= 0 ||
+        options.sample_rate > GB::CPU_CLOCK_RATE) {
+        return std::nullopt;
+    }
+
+    return options;
+}
+
+// FNV-1a, only used to tell frames apart
+uint64_t hash_frame(std::span<const uint8_t> pixels) {
+    uint64_t hash = 0xCBF29CE484222325;
+
+    for (uint8_t byte : pixels) {
+        hash = (hash ^ byte) * 0x100000001B3;
+    }
+
+    return hash;
+}
+
+bool write_ppm(const std::filesystem::path &path, std::span<const uint8_t> pixels) {
+    std::ofstream file(path, std::ios::binary);
+
+    if (!file) {
+        return false;
+    }
+
+    file << "P6\n" << GB::LCD_WIDTH << ' ' << GB::LCD_HEIGHT << "\n255\n";
+
+    for (size_t i = 0; i < pixels.size(); i += GB::FRAMEBUFFER_COLOR_CHANNELS) {
+        file.write(reinterpret_cast<const char *>(&pixels[i]), 3);
+    }
+
+    return static_cast<bool>(file);
+}
+
+int main(int argc, char *argv[]) {
+    auto options = parse_arguments(argc, argv);
+
+    if (!options) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    auto cart = GB::Cartridge::from_file(options->rom_path);
+
+    if (!cart) {
+        std::fprintf(stderr, "Unable to load '%s'\n", options->rom_path.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    GB::Core core;
+
+    if (cart->header().is_gbs) {
+        auto gbs = cart->gbs();
+
+        if (options->track > 0) {
+            gbs->select_track(static_cast<uint8_t>(options->track - 1));
+        }
+
+        std::printf("%s: track %d of %d\n", gbs->gbs_header().title.c_str(), gbs->track() + 1,
+                    gbs->track_count());
+
+        // Nothing is displayed for sound files so skip the pixel pipeline entirely
+        core.ppu.set_render_enabled(false);
+    }
+
+    core.initialize(cart.get());
+
+    GB::AudioRecorder recorder;
+
+    if (!options->wav_path.empty()) {
+        int32_t period = GB::CPU_CLOCK_RATE / options->sample_rate;
+
+        // The APU samples on whole cycles, record at the rate it actually produces
+        if (!recorder.open(options->wav_path, GB::CPU_CLOCK_RATE / period, options->stems)) {
+            std::fprintf(stderr, "Unable to open '%s'\n", options->wav_path.string().c_str());
+            return EXIT_FAILURE;
+        }
+
+        core.apu.set_samples_callback(
+            period, [&recorder](GB::SampleResult result) { recorder.push(result); });
+    } else {
+        core.set_audio_mode(GB::AudioMode::Silent);
+    }
+
+    std::optional<Headless::InputScript> script{};
+
+    if (!options->input_path.empty()) {
+        script = Headless::InputScript::from_file(options->input_path);
+
+        if (!script) {
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::FILE *hashes = nullptr;
+
+    if (!options->hashes_path.empty()) {
+        hashes = std::fopen(options->hashes_path.string().c_str(), "w");
+
+        if (!hashes) {
+            std::fprintf(stderr, "Unable to open '%s'\n", options->hashes_path.string().c_str());
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for (int32_t frame = 0; frame < options->frames; ++frame) {
+        if (script) {
+            const auto &buttons = script->buttons_for_frame(frame);
+            core.pad.clear_buttons();
+
+            for (size_t i = 0; i < buttons.size(); ++i) {
+                core.pad.set_pad_state(static_cast<GB::PadButton>(i), buttons[i]);
+            }
+        }
+
+        core.run_for_frames(1);
+
+        if (hashes) {
+            std::fprintf(hashes, "%d %016llx\n", frame,
+                         static_cast<unsigned long long>(hash_frame(core.ppu.framebuffer())));
+        }
+    }
+
+    recorder.close();
+    auto end = std::chrono::steady_clock::now();
+
+    if (hashes) {
+        std::fclose(hashes);
+    }
+
+    if (!options->screenshot_path.empty() &&
+        !write_ppm(options->screenshot_path, core.ppu.framebuffer())) {
+        std::fprintf(stderr, "Unable to write '%s'\n", options->screenshot_path.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    double emulated = static_cast<double>(options->frames) * GB::CYCLES_PER_FRAME /
+                      GB::CPU_CLOCK_RATE;
+
+    std::printf("%d frames in %.3fs (%.1f fps, %.1fx real time)\n", options->frames, seconds,
+                options->frames / seconds, emulated / seconds);
+
+    return EXIT_SUCCESS;
+}
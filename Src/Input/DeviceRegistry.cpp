@@ -17,19 +17,29 @@
 */
 
 #include "DeviceRegistry.hpp"
+#include <atomic>
 
 namespace Input {
     static std::unordered_set<InputDevice *> devices_;
+    // Bumped on the UI thread and read on the emulation thread
+    static std::atomic<uint64_t> generation_ = 0;
 
     std::unordered_set<InputDevice *> &devices() { return devices_; }
 
+    uint64_t generation() { return generation_; }
+
     void register_device(InputDevice *device) {
         if (!devices_.contains(device)) {
             devices_.insert(device);
+            ++generation_;
         }
     }
 
-    void remove_device(InputDevice *device) { devices_.erase(device); }
+    void remove_device(InputDevice *device) {
+        if (devices_.erase(device)) {
+            ++generation_;
+        }
+    }
 
     std::optional<InputDevice *> try_find_by_name(std::string_view name) {
         for (auto device : devices_) {
@@ -25,6 +25,9 @@
 namespace Input {
     std::unordered_set<InputDevice *> &devices();
 
+    // Changes whenever a device is registered or removed, lets callers cache lookups
+    uint64_t generation();
+
     std::optional<InputDevice *> try_find_by_name(std::string_view name);
     std::optional<InputDevice *> try_find_by_index(int32_t index);
     std::optional<int32_t> try_get_index_by_name(std::string_view name);
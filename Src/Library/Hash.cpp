@@ -0,0 +1,179 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Hash.hpp"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace Library {
+    static constexpr std::array<std::array<uint32_t, 256>, 8> make_crc_tables() {
+        std::array<std::array<uint32_t, 256>, 8> tables{};
+
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+
+            for (int32_t bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+            }
+
+            tables[0][i] = crc;
+        }
+
+        for (size_t slice = 1; slice < 8; ++slice) {
+            for (size_t i = 0; i < 256; ++i) {
+                uint32_t previous = tables[slice - 1][i];
+                tables[slice][i] = (previous >> 8) ^ tables[0][previous & 0xFF];
+            }
+        }
+
+        return tables;
+    }
+
+    static constexpr auto CRC_TABLES = make_crc_tables();
+
+    static uint32_t load_le32(const uint8_t *bytes) {
+        return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) |
+               (static_cast<uint32_t>(bytes[3]) << 24);
+    }
+
+    static uint32_t load_be32(const uint8_t *bytes) {
+        return (static_cast<uint32_t>(bytes[0]) << 24) | (bytes[1] << 16) | (bytes[2] << 8) |
+               bytes[3];
+    }
+
+    void CRC32::update(std::span<const uint8_t> data) {
+        const uint8_t *bytes = data.data();
+        size_t size = data.size();
+        uint32_t value = crc;
+
+        while (size >= 8) {
+            uint32_t low = load_le32(bytes) ^ value;
+            uint32_t high = load_le32(bytes + 4);
+
+            value = CRC_TABLES[7][low & 0xFF] ^ CRC_TABLES[6][(low >> 8) & 0xFF] ^
+                    CRC_TABLES[5][(low >> 16) & 0xFF] ^ CRC_TABLES[4][low >> 24] ^
+                    CRC_TABLES[3][high & 0xFF] ^ CRC_TABLES[2][(high >> 8) & 0xFF] ^
+                    CRC_TABLES[1][(high >> 16) & 0xFF] ^ CRC_TABLES[0][high >> 24];
+
+            bytes += 8;
+            size -= 8;
+        }
+
+        while (size--) {
+            value = (value >> 8) ^ CRC_TABLES[0][(value ^ *bytes++) & 0xFF];
+        }
+
+        crc = value;
+    }
+
+    uint32_t CRC32::value() const { return ~crc; }
+
+    void SHA1::update(std::span<const uint8_t> data) {
+        length += data.size();
+
+        if (buffered) {
+            size_t count = std::min(data.size(), buffer.size() - buffered);
+            std::memcpy(buffer.data() + buffered, data.data(), count);
+            buffered += count;
+            data = data.subspan(count);
+
+            if (buffered < buffer.size()) {
+                return;
+            }
+
+            process_block(buffer.data());
+            buffered = 0;
+        }
+
+        while (data.size() >= 64) {
+            process_block(data.data());
+            data = data.subspan(64);
+        }
+
+        std::memcpy(buffer.data(), data.data(), data.size());
+        buffered = data.size();
+    }
+
+    SHA1::Digest SHA1::finish() {
+        uint64_t bit_length = length * 8;
+        std::array<uint8_t, 72> padding{0x80};
+        size_t padding_size = (buffered < 56 ? 56 : 120) - buffered;
+
+        for (int32_t i = 0; i < 8; ++i) {
+            padding[padding_size + i] = static_cast<uint8_t>(bit_length >> (56 - i * 8));
+        }
+
+        update(std::span(padding).first(padding_size + 8));
+
+        Digest digest{};
+        for (size_t i = 0; i < state.size(); ++i) {
+            digest[i * 4 + 0] = static_cast<uint8_t>(state[i] >> 24);
+            digest[i * 4 + 1] = static_cast<uint8_t>(state[i] >> 16);
+            digest[i * 4 + 2] = static_cast<uint8_t>(state[i] >> 8);
+            digest[i * 4 + 3] = static_cast<uint8_t>(state[i]);
+        }
+
+        return digest;
+    }
+
+    void SHA1::process_block(const uint8_t *block) {
+        std::array<uint32_t, 80> w{};
+
+        for (size_t i = 0; i < 16; ++i) {
+            w[i] = load_be32(block + i * 4);
+        }
+
+        for (size_t i = 16; i < 80; ++i) {
+            w[i] = std::rotl(w[i - 3] ^ w[i - 8] ^ w[i - 14] ^ w[i - 16], 1);
+        }
+
+        uint32_t a = state[0], b = state[1], c = state[2], d = state[3], e = state[4];
+
+        for (size_t i = 0; i < 80; ++i) {
+            uint32_t f, k;
+
+            if (i < 20) {
+                f = (b & c) | (~b & d);
+                k = 0x5A827999;
+            } else if (i < 40) {
+                f = b ^ c ^ d;
+                k = 0x6ED9EBA1;
+            } else if (i < 60) {
+                f = (b & c) | (b & d) | (c & d);
+                k = 0x8F1BBCDC;
+            } else {
+                f = b ^ c ^ d;
+                k = 0xCA62C1D6;
+            }
+
+            uint32_t temp = std::rotl(a, 5) + f + e + k + w[i];
+            e = d;
+            d = c;
+            c = std::rotl(b, 30);
+            b = a;
+            a = temp;
+        }
+
+        state[0] += a;
+        state[1] += b;
+        state[2] += c;
+        state[3] += d;
+        state[4] += e;
+    }
+}
@@ -0,0 +1,51 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <array>
+#include <cinttypes>
+#include <span>
+
+namespace Library {
+    // CRC-32 (IEEE 802.3) as used by No-Intro and zip, processed eight bytes at a time with
+    // slicing-by-8 tables so the inner loop has no dependency on the previous byte
+    class CRC32 {
+    public:
+        void update(std::span<const uint8_t> data);
+        uint32_t value() const;
+
+    private:
+        uint32_t crc = 0xFFFFFFFF;
+    };
+
+    class SHA1 {
+    public:
+        using Digest = std::array<uint8_t, 20>;
+
+        void update(std::span<const uint8_t> data);
+        Digest finish();
+
+    private:
+        void process_block(const uint8_t *block);
+
+        std::array<uint32_t, 5> state{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0};
+        std::array<uint8_t, 64> buffer{};
+        size_t buffered = 0;
+        uint64_t length = 0;
+    };
+}
@@ -0,0 +1,370 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "RomLibrary.hpp"
+#include "Cores/GB/SaveWriter.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+namespace Library {
+    constexpr std::array<uint8_t, 4> INDEX_MAGIC{'B', 'C', 'B', 'L'};
+    constexpr uint32_t INDEX_VERSION = 1;
+    constexpr size_t HASH_CHUNK_SIZE = 0x10000;
+
+    static int64_t file_time(const std::filesystem::file_time_type &time) {
+        return static_cast<int64_t>(time.time_since_epoch().count());
+    }
+
+    // Little-endian encoding of the index, strings are prefixed with their length
+    class IndexWriter {
+    public:
+        void u8(uint8_t value) { data.push_back(value); }
+
+        void u16(uint16_t value) { integer(value, 2); }
+        void u32(uint32_t value) { integer(value, 4); }
+        void u64(uint64_t value) { integer(value, 8); }
+
+        void bytes(std::span<const uint8_t> values) {
+            data.insert(data.end(), values.begin(), values.end());
+        }
+
+        void string(const std::string &value) {
+            u32(static_cast<uint32_t>(value.size()));
+            data.insert(data.end(), value.begin(), value.end());
+        }
+
+        std::vector<uint8_t> data{};
+
+    private:
+        void integer(uint64_t value, size_t size) {
+            for (size_t i = 0; i < size; ++i) {
+                data.push_back(static_cast<uint8_t>(value >> (i * 8)));
+            }
+        }
+    };
+
+    // Every read past the end of the data yields zeroes and clears ok
+    class IndexReader {
+    public:
+        explicit IndexReader(std::span<const uint8_t> data) : data(data) {}
+
+        uint8_t u8() { return static_cast<uint8_t>(integer(1)); }
+        uint16_t u16() { return static_cast<uint16_t>(integer(2)); }
+        uint32_t u32() { return static_cast<uint32_t>(integer(4)); }
+        uint64_t u64() { return integer(8); }
+
+        void bytes(std::span<uint8_t> values) {
+            if (!take(values.size())) {
+                return;
+            }
+
+            std::copy_n(data.begin() + position - values.size(), values.size(), values.begin());
+        }
+
+        std::string string() {
+            size_t size = u32();
+
+            if (!take(size)) {
+                return {};
+            }
+
+            auto begin = reinterpret_cast<const char *>(data.data() + position - size);
+            return std::string(begin, size);
+        }
+
+        bool ok = true;
+
+    private:
+        bool take(size_t size) {
+            if (!ok || data.size() - position < size) {
+                ok = false;
+                return false;
+            }
+
+            position += size;
+            return true;
+        }
+
+        uint64_t integer(size_t size) {
+            if (!take(size)) {
+                return 0;
+            }
+
+            uint64_t value = 0;
+            for (size_t i = 0; i < size; ++i) {
+                value |= static_cast<uint64_t>(data[position - size + i]) << (i * 8);
+            }
+
+            return value;
+        }
+
+        std::span<const uint8_t> data;
+        size_t position = 0;
+    };
+
+    static void write_entry(IndexWriter &writer, const RomEntry &entry) {
+        auto path = entry.path.generic_u8string();
+        writer.string(std::string(path.begin(), path.end()));
+        writer.u64(entry.file_size);
+        writer.u64(static_cast<uint64_t>(entry.write_time));
+        writer.u32(entry.crc32);
+        writer.bytes(entry.sha1);
+
+        const auto &header = entry.header;
+        writer.string(header.title);
+        writer.u8(header.cgb_support);
+        writer.u8(header.sgb_flag);
+        writer.u8(header.mbc_type);
+        writer.u8(header.region_code);
+        writer.u8(header.old_license_code);
+        writer.u8(header.version);
+        writer.u8(header.header_checksum);
+        writer.u16(header.license_code);
+        writer.u16(header.checksum);
+        writer.u8(static_cast<uint8_t>(header.rom_size));
+        writer.u8(static_cast<uint8_t>(header.ram_size));
+        writer.u8(header.is_gbs);
+    }
+
+    static RomEntry read_index_entry(IndexReader &reader) {
+        RomEntry entry{};
+        auto path = reader.string();
+        // Stored with forward slashes, scans compare against the native form
+        entry.path = std::u8string(path.begin(), path.end());
+        entry.path.make_preferred();
+        entry.file_size = reader.u64();
+        entry.write_time = static_cast<int64_t>(reader.u64());
+        entry.crc32 = reader.u32();
+        reader.bytes(entry.sha1);
+
+        auto &header = entry.header;
+        header.file_path = entry.path;
+        header.title = reader.string();
+        header.cgb_support = reader.u8();
+        header.sgb_flag = reader.u8();
+        header.mbc_type = reader.u8();
+        header.region_code = reader.u8();
+        header.old_license_code = reader.u8();
+        header.version = reader.u8();
+        header.header_checksum = reader.u8();
+        header.license_code = reader.u16();
+        header.checksum = reader.u16();
+        header.rom_size = static_cast<GB::RomSize>(reader.u8());
+        header.ram_size = static_cast<GB::RamSize>(reader.u8());
+        header.is_gbs = reader.u8();
+
+        return entry;
+    }
+
+    RomLibrary::RomLibrary(std::filesystem::path index_path) : index_path(std::move(index_path)) {}
+
+    const std::vector<RomEntry> &RomLibrary::entries() const { return roms; }
+
+    bool RomLibrary::load_index() {
+        std::ifstream file(index_path, std::ios::binary | std::ios::ate);
+
+        if (!file) {
+            return false;
+        }
+
+        std::vector<uint8_t> contents(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char *>(contents.data()),
+                  static_cast<std::streamsize>(contents.size()));
+
+        IndexReader reader(contents);
+        std::array<uint8_t, 4> magic{};
+        reader.bytes(magic);
+
+        if (magic != INDEX_MAGIC || reader.u32() != INDEX_VERSION) {
+            return false;
+        }
+
+        std::vector<RomEntry> loaded{};
+        uint32_t count = reader.u32();
+
+        for (uint32_t i = 0; i < count && reader.ok; ++i) {
+            loaded.push_back(read_index_entry(reader));
+        }
+
+        if (!reader.ok) {
+            return false;
+        }
+
+        roms = std::move(loaded);
+        return true;
+    }
+
+    bool RomLibrary::save_index() const {
+        IndexWriter writer{};
+        writer.bytes(INDEX_MAGIC);
+        writer.u32(INDEX_VERSION);
+        writer.u32(static_cast<uint32_t>(roms.size()));
+
+        for (const auto &entry : roms) {
+            write_entry(writer, entry);
+        }
+
+        return GB::write_save_file(index_path, writer.data);
+    }
+
+    ScanResult RomLibrary::scan(std::span<const std::filesystem::path> directories,
+                                Common::ThreadPool &pool) {
+        ScanResult result{};
+        std::unordered_map<std::filesystem::path::string_type, RomEntry> previous{};
+
+        for (auto &entry : roms) {
+            previous.emplace(entry.path.native(), std::move(entry));
+        }
+
+        roms.clear();
+
+        std::vector<RomEntry> found{};
+        std::vector<std::filesystem::path> changed{};
+        // The same file can be reached through overlapping directories
+        std::unordered_set<std::filesystem::path::string_type> seen{};
+
+        for (const auto &directory : directories) {
+            std::error_code error{};
+            auto options = std::filesystem::directory_options::skip_permission_denied;
+            std::filesystem::recursive_directory_iterator it(directory, options, error);
+
+            for (; !error && it != std::filesystem::recursive_directory_iterator();
+                 it.increment(error)) {
+                const auto &file = *it;
+                std::error_code stat_error{};
+
+                if (!file.is_regular_file(stat_error) || !is_rom_file(file.path())) {
+                    continue;
+                }
+
+                uint64_t size = file.file_size(stat_error);
+                if (stat_error) {
+                    continue;
+                }
+
+                int64_t write_time = file_time(file.last_write_time(stat_error));
+                if (stat_error) {
+                    continue;
+                }
+
+                auto path = file.path().lexically_normal();
+
+                if (!seen.insert(path.native()).second) {
+                    continue;
+                }
+
+                auto cached = previous.find(path.native());
+
+                if (cached != previous.end() && cached->second.file_size == size &&
+                    cached->second.write_time == write_time) {
+                    found.push_back(std::move(cached->second));
+                    previous.erase(cached);
+                    ++result.reused;
+                } else {
+                    changed.push_back(std::move(path));
+                }
+            }
+        }
+
+        // Each job owns one slot, nothing is shared until wait() returns
+        std::vector<std::optional<RomEntry>> hashed(changed.size());
+
+        for (size_t i = 0; i < changed.size(); ++i) {
+            pool.submit([&changed, &hashed, i] { hashed[i] = read_entry(changed[i]); });
+        }
+
+        pool.wait();
+
+        for (auto &entry : hashed) {
+            if (entry) {
+                found.push_back(std::move(*entry));
+                ++result.hashed;
+            } else {
+                ++result.skipped;
+            }
+        }
+
+        std::sort(found.begin(), found.end(),
+                  [](const RomEntry &a, const RomEntry &b) { return a.path < b.path; });
+
+        roms = std::move(found);
+        return result;
+    }
+
+    bool RomLibrary::is_rom_file(const std::filesystem::path &path) {
+        auto extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return std::tolower(c); });
+
+        return extension == ".gb" || extension == ".gbc" || extension == ".gbs";
+    }
+
+    std::optional<RomEntry> RomLibrary::read_entry(const std::filesystem::path &path) {
+        std::ifstream file(path, std::ios::binary);
+
+        if (!file) {
+            return std::nullopt;
+        }
+
+        RomEntry entry{};
+        entry.path = path;
+
+        std::error_code error{};
+        entry.file_size = std::filesystem::file_size(path, error);
+        entry.write_time = file_time(std::filesystem::last_write_time(path, error));
+
+        if (error) {
+            return std::nullopt;
+        }
+
+        std::vector<uint8_t> buffer(HASH_CHUNK_SIZE);
+        CRC32 crc{};
+        SHA1 sha1{};
+
+        // The first chunk holds the header, the rest of the file is only hashed
+        file.read(reinterpret_cast<char *>(buffer.data()), GB::CART_HEADER_END);
+        auto header_bytes = std::span(buffer).first(static_cast<size_t>(file.gcount()));
+
+        if (!GB::parse_cart_header(header_bytes, entry.header)) {
+            return std::nullopt;
+        }
+
+        entry.header.file_path = path;
+        crc.update(header_bytes);
+        sha1.update(header_bytes);
+
+        while (file) {
+            file.read(reinterpret_cast<char *>(buffer.data()), buffer.size());
+            auto chunk = std::span(buffer).first(static_cast<size_t>(file.gcount()));
+
+            crc.update(chunk);
+            sha1.update(chunk);
+        }
+
+        entry.crc32 = crc.value();
+        entry.sha1 = sha1.finish();
+
+        return entry;
+    }
+}
@@ -0,0 +1,75 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "Common/ThreadPool.hpp"
+#include "Cores/GB/Cartridge.hpp"
+#include "Hash.hpp"
+#include <cinttypes>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace Library {
+    struct RomEntry {
+        std::filesystem::path path;
+        uint64_t file_size = 0;
+        int64_t write_time = 0;
+
+        GB::CartHeader header{};
+        uint32_t crc32 = 0;
+        SHA1::Digest sha1{};
+    };
+
+    struct ScanResult {
+        size_t reused = 0;
+        size_t hashed = 0;
+        size_t skipped = 0;
+    };
+
+    // Index of every ROM below a set of directories. Files are only opened when they are new or
+    // their size or modification time changed since the index was written, so rescanning a large
+    // collection mostly costs a directory walk.
+    class RomLibrary {
+    public:
+        explicit RomLibrary(std::filesystem::path index_path);
+        ~RomLibrary() = default;
+        RomLibrary(const RomLibrary &) = delete;
+        RomLibrary(RomLibrary &&) = delete;
+        RomLibrary &operator=(const RomLibrary &) = delete;
+        RomLibrary &operator=(RomLibrary &&) = delete;
+
+        // Sorted by path
+        const std::vector<RomEntry> &entries() const;
+
+        bool load_index();
+        bool save_index() const;
+
+        ScanResult scan(std::span<const std::filesystem::path> directories,
+                        Common::ThreadPool &pool);
+
+        static bool is_rom_file(const std::filesystem::path &path);
+        // Parses the header from the first bytes of the file and hashes the whole of it
+        static std::optional<RomEntry> read_entry(const std::filesystem::path &path);
+
+    private:
+        std::filesystem::path index_path;
+        std::vector<RomEntry> roms{};
+    };
+}
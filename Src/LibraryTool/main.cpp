@@ -0,0 +1,88 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Library/RomLibrary.hpp"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+struct Options {
+    std::vector<std::filesystem::path> library_paths;
+    std::filesystem::path index_path = "library.idx";
+};
+
+void print_usage() {
+    std::puts("usage: BigComBoyLibrary <dir>... [options]\n"
+              "  --index <path>      index to update (default library.idx)");
+}
+
+std::optional<Options> parse_arguments(int argc, char *argv[]) {
+    Options options{};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--index" && has_value) {
+            options.index_path = argv[++i];
+        } else if (!arg.starts_with("--")) {
+            options.library_paths.push_back(arg);
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    if (options.library_paths.empty()) {
+        return std::nullopt;
+    }
+
+    return options;
+}
+
+int main(int argc, char *argv[]) {
+    auto options = parse_arguments(argc, argv);
+
+    if (!options) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    Library::RomLibrary library(options->index_path);
+    Common::ThreadPool pool{};
+
+    auto start = std::chrono::steady_clock::now();
+    library.load_index();
+    auto result = library.scan(options->library_paths, pool);
+    auto end = std::chrono::steady_clock::now();
+
+    if (!library.save_index()) {
+        std::fprintf(stderr, "Unable to write '%s'\n", options->index_path.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%zu ROMs (%zu cached, %zu hashed, %zu skipped) in %.3fs on %zu threads\n",
+                library.entries().size(), result.reused, result.hashed, result.skipped, seconds,
+                pool.thread_count());
+
+    return EXIT_SUCCESS;
+}
@@ -27,6 +27,7 @@
 #include <QLabel>
 #include <QScreen>
 #include <QWindow>
+#include <algorithm>
 #include <fmt/format.h>
 
 namespace QtFrontend {
@@ -62,11 +63,17 @@ namespace QtFrontend {
 
     void EmulatorThread::stop() { running = false; }
 
+    void EmulatorThread::set_speed(float multiplier) {
+        speed = std::clamp(multiplier, GB::MIN_EMULATION_SPEED, GB::MAX_EMULATION_SPEED);
+    }
+
     void EmulatorThread::run() {
         auto accumulator = std::chrono::nanoseconds::zero();
         auto last_timer_time = std::chrono::steady_clock::now();
         auto last_callback_time = std::chrono::steady_clock::now();
-        auto interval = Common::Math::freq_to_nanoseconds(60);
+        const auto base_interval = Common::Math::freq_to_nanoseconds(60);
+        auto interval = base_interval;
+        float current_speed = 1.0f;
 
         std::array<double, 100> samples{};
         size_t next = 0;
@@ -78,6 +85,14 @@ namespace QtFrontend {
 
             if (gb_controller->get_state() != EmulationState::Stopped) {
                 using namespace std::chrono_literals;
+
+                if (current_speed != speed) {
+                    current_speed = speed;
+                    interval = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                        base_interval / static_cast<double>(current_speed));
+                    gb_controller->set_speed(current_speed);
+                }
+
                 auto time_now = std::chrono::steady_clock::now();
                 auto delta = time_now - last_timer_time;
 
@@ -111,7 +126,7 @@ namespace QtFrontend {
 
                     if (gb_controller->try_run_frame()) {
                         auto &image = image_buffer.next_rendering_image();
-                        auto ppu_image = gb_controller->get_core().ppu.framebuffer();
+                        auto ppu_image = gb_controller->framebuffer();
 
                         std::copy(ppu_image.begin(), ppu_image.end(), image.begin());
 
@@ -230,6 +245,20 @@ namespace QtFrontend {
 
         connect(window, &MainWindow::rom_loaded, thread->gb_controller,
                 &GBEmulatorController::start_rom);
+
+        connect(window, &MainWindow::speed_changed, thread, &EmulatorThread::set_speed);
+
+        connect(window, &MainWindow::rewind_held, thread->gb_controller,
+                &GBEmulatorController::set_rewinding);
+
+        // Each controller keeps its own copy, the emulator thread never reads the shared config
+        connect(window, &MainWindow::config_changed, thread->gb_controller,
+                &GBEmulatorController::apply_config);
+
+        connect(window, &MainWindow::config_changed, thread,
+                [controller = thread->gb_controller](const Common::GBConfig &config) {
+                    controller->set_input_mappings(config.input_mappings);
+                });
     }
 
     void EmulatorView::update_textures() {
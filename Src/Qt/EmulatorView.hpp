@@ -18,6 +18,7 @@
 
 #pragma once
 #include "Cores/GB/Constants.hpp"
+#include "Cores/GB/TimeStretcher.hpp"
 #include "SwapChain.hpp"
 #include <QOpenGLWidget>
 #include <QThread>
@@ -52,6 +53,7 @@ namespace QtFrontend {
 
         void stop();
         void run() override;
+        Q_SLOT void set_speed(float multiplier);
 
         void update_input();
         Q_SIGNAL void on_update_fps_display(const QString &text);
@@ -60,6 +62,7 @@ namespace QtFrontend {
 
     private:
         std::atomic_bool running = true;
+        std::atomic<float> speed = 1.0f;
 
         QTimer input_timer;
 
@@ -17,13 +17,11 @@
 */
 
 #include "AudioSystem.hpp"
-#include "Common/Config.hpp"
 #include "Cores/GB/Constants.hpp"
 
 namespace QtFrontend {
     constexpr bool SYNC_TO_AUDIO = true;
     constexpr float MAX_LAG = 0.04f;
-    constexpr float VOLUME_SCALE = 255.0f;
 
     AudioSystem::AudioSystem() { open_device(); }
 
@@ -47,7 +45,7 @@ namespace QtFrontend {
 
     void AudioSystem::close_device() {
         SDL_CloseAudioDevice(audio_device);
-        samples.clear();
+        block.clear();
         opened = false;
         audio_device = 0;
     }
@@ -69,58 +67,18 @@ namespace QtFrontend {
     }
 
     void AudioSystem::operator()(GB::SampleResult result) {
-        const auto &config = Common::Config::current().gameboy;
-
-        float left_vol = static_cast<float>(128 * result.left_channel.master_volume) / 7;
-        float right_vol = static_cast<float>(128 * result.right_channel.master_volume) / 7;
-
-        float volume = static_cast<float>(config.audio.volume) / 100.0f;
-        float square1 = static_cast<float>(config.audio.square1) / 100.0f;
-        float square2 = static_cast<float>(config.audio.square2) / 100.0f;
-        float wave = static_cast<float>(config.audio.wave) / 100.0f;
-        float noise = static_cast<float>(config.audio.noise) / 100.0f;
-
-        float sample_left = 0;
-        float input = static_cast<float>(result.left_channel.pulse_1) / VOLUME_SCALE;
-        SDL_MixAudioFormat(reinterpret_cast<Uint8 *>(&sample_left),
-                           reinterpret_cast<Uint8 *>(&input), AUDIO_F32SYS, sizeof(float),
-                           static_cast<int>(left_vol * square1));
-        input = static_cast<float>(result.left_channel.pulse_2) / VOLUME_SCALE;
-        SDL_MixAudioFormat(reinterpret_cast<Uint8 *>(&sample_left),
-                           reinterpret_cast<Uint8 *>(&input), AUDIO_F32SYS, sizeof(float),
-                           static_cast<int>(left_vol * square2));
-        input = static_cast<float>(result.left_channel.wave) / VOLUME_SCALE;
-        SDL_MixAudioFormat(reinterpret_cast<Uint8 *>(&sample_left),
-                           reinterpret_cast<Uint8 *>(&input), AUDIO_F32SYS, sizeof(float),
-                           static_cast<int>(left_vol * wave));
-        input = static_cast<float>(result.left_channel.noise) / VOLUME_SCALE;
-        SDL_MixAudioFormat(reinterpret_cast<Uint8 *>(&sample_left),
-                           reinterpret_cast<Uint8 *>(&input), AUDIO_F32SYS, sizeof(float),
-                           static_cast<int>(left_vol * noise));
-
-        float sample_right = 0;
-        input = static_cast<float>(result.right_channel.pulse_1) / VOLUME_SCALE;
-        SDL_MixAudioFormat(reinterpret_cast<Uint8 *>(&sample_right),
-                           reinterpret_cast<Uint8 *>(&input), AUDIO_F32SYS, sizeof(float),
-                           static_cast<int>(right_vol * square1));
-        input = static_cast<float>(result.right_channel.pulse_2) / VOLUME_SCALE;
-        SDL_MixAudioFormat(reinterpret_cast<Uint8 *>(&sample_right),
-                           reinterpret_cast<Uint8 *>(&input), AUDIO_F32SYS, sizeof(float),
-                           static_cast<int>(right_vol * square2));
-        input = static_cast<float>(result.right_channel.wave) / VOLUME_SCALE;
-        SDL_MixAudioFormat(reinterpret_cast<Uint8 *>(&sample_right),
-                           reinterpret_cast<Uint8 *>(&input), AUDIO_F32SYS, sizeof(float),
-                           static_cast<int>(right_vol * wave));
-        input = static_cast<float>(result.right_channel.noise) / VOLUME_SCALE;
-        SDL_MixAudioFormat(reinterpret_cast<Uint8 *>(&sample_right),
-                           reinterpret_cast<Uint8 *>(&input), AUDIO_F32SYS, sizeof(float),
-                           static_cast<int>(right_vol * noise));
-
-        samples.push_back({.left = sample_left * volume, .right = sample_right * volume});
-
-        if (samples.size() == obtained.samples) {
-            SDL_QueueAudio(audio_device, samples.data(), samples.size() * sizeof(AudioSample));
-            samples.clear();
+        block.push(result);
+
+        if (block.full()) {
+            mixer.mix(block, settings, output);
+            stretcher.process(std::span(output.data(), block.size() * 2), stretched);
+
+            if (!stretched.empty()) {
+                SDL_QueueAudio(audio_device, stretched.data(), stretched.size() * sizeof(float));
+                stretched.clear();
+            }
+
+            block.clear();
         }
     }
 
@@ -130,10 +88,19 @@ namespace QtFrontend {
         }
 
         SDL_PauseAudioDevice(audio_device, 0);
-        samples.clear();
-        samples.reserve(obtained.samples);
+        block.resize(obtained.samples);
+        output.resize(static_cast<size_t>(obtained.samples) * 2);
+        mixer.set_sample_rate(obtained.freq);
+        mixer.reset();
+        stretcher.reset();
 
         apu.set_samples_callback(GB::CPU_CLOCK_RATE / obtained.freq,
                                  [this](GB::SampleResult samples) { this->operator()(samples); });
     }
+
+    void AudioSystem::set_speed(float speed) { stretcher.set_speed(speed); }
+
+    void AudioSystem::set_mixer_settings(const GB::MixerSettings &new_settings) {
+        settings = new_settings;
+    }
 }
\ No newline at end of file
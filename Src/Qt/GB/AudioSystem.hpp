@@ -18,6 +18,8 @@
 
 #pragma once
 #include "Cores/GB/APU.hpp"
+#include "Cores/GB/AudioMixer.hpp"
+#include "Cores/GB/TimeStretcher.hpp"
 #include <SDL.h>
 #include <vector>
 
@@ -41,11 +43,18 @@ namespace QtFrontend {
         bool should_continue();
         void operator()(GB::SampleResult result);
         void prep_for_playback(GB::APU &apu);
+        void set_speed(float speed);
+        void set_mixer_settings(const GB::MixerSettings &new_settings);
 
     private:
         bool opened = false;
         SDL_AudioSpec obtained{};
         SDL_AudioDeviceID audio_device = 0;
-        std::vector<AudioSample> samples{};
+        GB::SampleBlock block{};
+        GB::AudioMixer mixer{};
+        GB::MixerSettings settings{};
+        std::vector<float> output{};
+        GB::TimeStretcher stretcher{};
+        std::vector<float> stretched{};
     };
 }
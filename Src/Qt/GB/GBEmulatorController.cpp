@@ -17,12 +17,17 @@
 */
 
 #include "GBEmulatorController.hpp"
-#include "Common/Config.hpp"
 #include "Input/DeviceRegistry.hpp"
+#include <algorithm>
 
 namespace QtFrontend {
     GBEmulatorController::GBEmulatorController() : QObject(nullptr), sram_timer(new QTimer(this)) {
         connect(sram_timer, &QTimer::timeout, this, &GBEmulatorController::save_sram);
+
+        const auto &current = Common::Config::current().gameboy;
+        apply_config(current);
+        configure_rewind();
+        set_input_mappings(current.input_mappings);
     }
 
     GBEmulatorController::~GBEmulatorController() { sram_timer->stop(); }
@@ -31,49 +36,93 @@ namespace QtFrontend {
 
     GB::Core &GBEmulatorController::get_core() { return core; }
 
+    std::span<const uint8_t> GBEmulatorController::framebuffer() {
+        if (rewinding && config.emulation.rewind_enabled) {
+            return core.ppu.framebuffer();
+        }
+
+        return run_ahead.framebuffer(core);
+    }
+
     bool GBEmulatorController::try_run_frame() {
         using namespace std::chrono_literals;
 
         if (state == EmulationState::Running && audio_system.should_continue()) {
-            core.run_for_frames(1);
+            if (rewinding && config.emulation.rewind_enabled) {
+                rewind_buffer.rewind(core);
+                return true;
+            }
+
+            core.set_audio_mode(config.audio.volume == 0 ? GB::AudioMode::Silent
+                                                         : GB::AudioMode::Full);
+            run_ahead.run_frame(core);
+
+            if (config.emulation.rewind_enabled) {
+                rewind_buffer.capture(core);
+            }
+
             return true;
         }
 
         return false;
     }
 
+    void GBEmulatorController::set_speed(float speed) { audio_system.set_speed(speed); }
+
     void GBEmulatorController::process_input(std::array<bool, 8> &buttons) {
-        const auto &mappings = Common::Config::current().gameboy.input_mappings;
+        if (!input_resolved || input_generation != Input::generation()) {
+            resolve_input_devices();
+        }
 
-        for (const auto &mapping : mappings) {
-            auto device_option = Input::try_find_by_name(mapping.device_name);
+        for (size_t m = 0; m < input_mappings.size(); ++m) {
+            auto device = input_devices[m];
 
-            if (device_option) {
-                auto device = device_option.value();
+            if (!device) {
+                continue;
+            }
 
-                for (int i = 0; i < mapping.buttons.size(); ++i) {
-                    if (device->is_key_down(mapping.buttons[i])) {
-                        buttons[i] = true;
-                    }
+            const auto &mapping = input_mappings[m];
+
+            for (int i = 0; i < mapping.buttons.size(); ++i) {
+                if (device->is_key_down(mapping.buttons[i])) {
+                    buttons[i] = true;
                 }
             }
         }
     }
 
+    void GBEmulatorController::set_input_mappings(
+        const std::array<Common::GBGamepadConfig, 2> &mappings) {
+        input_mappings = mappings;
+        input_resolved = false;
+    }
+
+    void GBEmulatorController::resolve_input_devices() {
+        for (size_t m = 0; m < input_mappings.size(); ++m) {
+            input_devices[m] =
+                Input::try_find_by_name(input_mappings[m].device_name).value_or(nullptr);
+        }
+
+        input_generation = Input::generation();
+        input_resolved = true;
+    }
+
     void GBEmulatorController::start_rom(std::filesystem::path path) {
         auto new_cart = GB::Cartridge::from_file(path);
 
         if (cart) {
-            cart->save_sram_to_file();
+            save_writer.flush(*cart);
             cart.reset();
         }
 
         if (new_cart) {
-            const auto &emulation = Common::Config::current().gameboy.emulation;
+            const auto &emulation = config.emulation;
 
             cart = std::move(new_cart);
 
             init_by_console_type();
+            configure_run_ahead();
+            rewind_buffer.clear();
 
             audio_system.prep_for_playback(core.apu);
 
@@ -98,6 +147,12 @@ namespace QtFrontend {
         for (int i = 0; i < buttons.size(); ++i) {
             core.pad.set_pad_state(static_cast<PadButton>(i), buttons[i]);
         }
+
+        if (cart && cart->header().is_gbs) {
+            change_track(buttons);
+        }
+
+        previous_buttons = buttons;
     }
 
     void GBEmulatorController::set_pause(bool checked) {
@@ -119,7 +174,8 @@ namespace QtFrontend {
     void GBEmulatorController::stop_emulation() {
         sram_timer->stop();
         core.initialize(nullptr);
-        cart->save_sram_to_file();
+        rewind_buffer.clear();
+        save_writer.flush(*cart);
         cart.reset();
         state = EmulationState::Stopped;
         emit on_hide();
@@ -127,21 +183,78 @@ namespace QtFrontend {
 
     void GBEmulatorController::reset_emulation() {
         init_by_console_type();
+        configure_run_ahead();
+        rewind_buffer.clear();
         audio_system.prep_for_playback(core.apu);
     }
 
     void GBEmulatorController::save_sram() {
-        int32_t interval_seconds =
-            Common::Config::current().gameboy.emulation.sram_save_interval * 1000;
-        cart->save_sram_to_file();
+        int32_t interval_seconds = config.emulation.sram_save_interval * 1000;
+        save_writer.queue(*cart);
 
         if (sram_timer->interval() != interval_seconds) {
             sram_timer->setInterval(interval_seconds);
         }
     }
 
+    void GBEmulatorController::apply_config(const Common::GBConfig &new_config) {
+        const auto &old_emulation = config.emulation;
+        const auto &new_emulation = new_config.emulation;
+        bool rewind_changed = old_emulation.rewind_enabled != new_emulation.rewind_enabled ||
+                              old_emulation.rewind_seconds != new_emulation.rewind_seconds ||
+                              old_emulation.rewind_memory_mb != new_emulation.rewind_memory_mb;
+
+        config = new_config;
+
+        // Reconfiguring drops the history, other settings leave it alone
+        if (rewind_changed) {
+            configure_rewind();
+        }
+
+        if (cart) {
+            configure_run_ahead();
+        }
+
+        GB::MixerSettings settings{};
+        settings.volume = static_cast<float>(config.audio.volume) / 100.0f;
+        settings.channels = {
+            static_cast<float>(config.audio.square1) / 100.0f,
+            static_cast<float>(config.audio.square2) / 100.0f,
+            static_cast<float>(config.audio.wave) / 100.0f,
+            static_cast<float>(config.audio.noise) / 100.0f,
+        };
+
+        audio_system.set_mixer_settings(settings);
+    }
+
+    void GBEmulatorController::set_rewinding(bool held) { rewinding = held; }
+
+    void GBEmulatorController::configure_rewind() {
+        const auto &emulation = config.emulation;
+
+        GB::RewindSettings settings{};
+        settings.max_frames = std::max(emulation.rewind_seconds, 1) * 60;
+        settings.memory_budget = static_cast<size_t>(std::max(emulation.rewind_memory_mb, 1))
+                                 << 20;
+        rewind_buffer.configure(settings);
+    }
+
+    void GBEmulatorController::configure_run_ahead() {
+        // Sound files show nothing, there is no picture to get earlier
+        run_ahead.set_frames(cart->header().is_gbs ? 0 : config.emulation.run_ahead_frames);
+        run_ahead.prepare(core);
+    }
+
     void GBEmulatorController::init_by_console_type() {
-        const auto &emulation = Common::Config::current().gameboy.emulation;
+        const auto &emulation = config.emulation;
+
+        // Sound files have nothing to show and no boot ROM compatible header
+        core.ppu.set_render_enabled(!cart->header().is_gbs);
+
+        if (cart->header().is_gbs) {
+            core.initialize(cart.get());
+            return;
+        }
 
         switch (emulation.console) {
         case GB::ConsoleType::AutoSelect: {
@@ -158,4 +271,24 @@ namespace QtFrontend {
         }
         }
     }
-}
\ No newline at end of file
+
+    void GBEmulatorController::change_track(const std::array<bool, 8> &buttons) {
+        auto gbs = cart->gbs();
+        auto pressed = [&](GB::PadButton button) {
+            auto index = static_cast<size_t>(button);
+            return buttons[index] && !previous_buttons[index];
+        };
+
+        if (!gbs || state != EmulationState::Running) {
+            return;
+        }
+
+        if (pressed(GB::PadButton::Right)) {
+            gbs->select_track(gbs->track() + 1);
+            reset_emulation();
+        } else if (pressed(GB::PadButton::Left)) {
+            gbs->select_track(gbs->track() + gbs->track_count() - 1);
+            reset_emulation();
+        }
+    }
+}
@@ -18,13 +18,18 @@
 
 #pragma once
 #include "AudioSystem.hpp"
+#include "Common/Config.hpp"
 #include "Common/Math.hpp"
 #include "Cores/GB/Core.hpp"
+#include "Cores/GB/Rewind.hpp"
+#include "Cores/GB/RunAhead.hpp"
+#include "Cores/GB/SaveWriter.hpp"
 #include <QObject>
 #include <QTimer>
 #include <array>
 #include <filesystem>
 #include <memory>
+#include <span>
 
 namespace GL {
     class Renderer;
@@ -48,9 +53,14 @@ namespace QtFrontend {
 
         EmulationState get_state() const;
         GB::Core &get_core();
+        // What to show for the last frame, which is ahead of the core with run-ahead enabled
+        std::span<const uint8_t> framebuffer();
 
         bool try_run_frame();
+        void set_speed(float speed);
+        // Input is polled on the GUI thread, these two must only be called from there
         void process_input(std::array<bool, 8> &buttons);
+        void set_input_mappings(const std::array<Common::GBGamepadConfig, 2> &mappings);
 
         Q_SLOT void start_rom(std::filesystem::path path);
         Q_SLOT void copy_input(std::array<bool, 8> input);
@@ -58,6 +68,9 @@ namespace QtFrontend {
         Q_SLOT void stop_emulation();
         Q_SLOT void reset_emulation();
         Q_SLOT void save_sram();
+        Q_SLOT void apply_config(const Common::GBConfig &new_config);
+        // While held, each frame steps back through the rewind buffer instead of running
+        Q_SLOT void set_rewinding(bool held);
 
         Q_SIGNAL void on_load_success(const QString &message, int timeout = 0);
         Q_SIGNAL void on_load_fail(const QString &message, int timeout = 0);
@@ -65,13 +78,31 @@ namespace QtFrontend {
         Q_SIGNAL void on_hide();
 
     private:
+        void resolve_input_devices();
         void init_by_console_type();
+        void change_track(const std::array<bool, 8> &buttons);
+        void configure_rewind();
+        void configure_run_ahead();
 
         EmulationState state = EmulationState::Stopped;
         GB::Core core{};
         std::unique_ptr<GB::Cartridge> cart;
         AudioSystem audio_system{};
+        std::array<bool, 8> previous_buttons{};
+        GB::RewindBuffer rewind_buffer{};
+        bool rewinding = false;
+        GB::RunAhead run_ahead{};
+
+        // Owned by the emulator thread, replaced as a whole when settings are applied
+        Common::GBConfig config{};
+
+        // Owned by the GUI thread
+        std::array<Common::GBGamepadConfig, 2> input_mappings{};
+        std::array<Input::InputDevice *, 2> input_devices{};
+        uint64_t input_generation = 0;
+        bool input_resolved = false;
 
         QTimer *sram_timer = nullptr;
+        GB::SaveWriter save_writer{};
     };
 }
\ No newline at end of file
@@ -50,9 +50,22 @@ namespace QtFrontend {
         connect(ui->sram_interval, &QSpinBox::valueChanged, this,
                 &EmulationWindow::change_interval);
 
+        connect(ui->rewind_enabled, &QCheckBox::clicked, this,
+                &EmulationWindow::set_rewind_enabled);
+        connect(ui->rewind_seconds, &QSpinBox::valueChanged, this,
+                &EmulationWindow::change_rewind_seconds);
+        connect(ui->rewind_memory, &QSpinBox::valueChanged, this,
+                &EmulationWindow::change_rewind_memory);
+        connect(ui->run_ahead_frames, &QSpinBox::valueChanged, this,
+                &EmulationWindow::change_run_ahead);
+
         ui->allow_sram->setChecked(emulation.allow_sram_saving);
         ui->rich_presence->setChecked(emulation.use_rpc);
         ui->sram_interval->setValue(emulation.sram_save_interval);
+        ui->rewind_enabled->setChecked(emulation.rewind_enabled);
+        ui->rewind_seconds->setValue(emulation.rewind_seconds);
+        ui->rewind_memory->setValue(emulation.rewind_memory_mb);
+        ui->run_ahead_frames->setValue(emulation.run_ahead_frames);
 
         std::array<QRadioButton *, 3> btns{
 
@@ -107,6 +120,16 @@ namespace QtFrontend {
 
     void EmulationWindow::change_interval(int32_t value) { emulation.sram_save_interval = value; }
 
+    void EmulationWindow::set_rewind_enabled(bool checked) { emulation.rewind_enabled = checked; }
+
+    void EmulationWindow::change_rewind_seconds(int32_t value) { emulation.rewind_seconds = value; }
+
+    void EmulationWindow::change_rewind_memory(int32_t value) {
+        emulation.rewind_memory_mb = value;
+    }
+
+    void EmulationWindow::change_run_ahead(int32_t value) { emulation.run_ahead_frames = value; }
+
     void EmulationWindow::set_console(QAbstractButton *btn) {
         if (btn == ui->auto_btn) {
             emulation.console = GB::ConsoleType::AutoSelect;
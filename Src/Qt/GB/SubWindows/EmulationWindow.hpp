@@ -44,6 +44,10 @@ namespace QtFrontend {
         Q_SLOT void set_allow_sram(bool checked);
         Q_SLOT void set_use_rpc(bool checked);
         Q_SLOT void change_interval(int32_t value);
+        Q_SLOT void set_rewind_enabled(bool checked);
+        Q_SLOT void change_rewind_seconds(int32_t value);
+        Q_SLOT void change_rewind_memory(int32_t value);
+        Q_SLOT void change_run_ahead(int32_t value);
         Q_SLOT void set_console(QAbstractButton *btn);
         Q_SLOT void boot_path_changed(const QString &path);
 
@@ -71,6 +71,7 @@ namespace QtFrontend {
 
         if (name == "Apply" || name == "OK") {
             emit apply_changes_to_tabs();
+            emit changes_applied();
 
             Common::Config::current().write_to_file(QtFrontend::Paths::ConfigLocation());
         }
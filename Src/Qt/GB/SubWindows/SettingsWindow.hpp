@@ -42,6 +42,7 @@ namespace QtFrontend {
         Q_SLOT void dialog_clicked(QAbstractButton *button);
         Q_SLOT void set_tab_focus(bool allowed);
         Q_SIGNAL void apply_changes_to_tabs();
+        Q_SIGNAL void changes_applied();
 
     private:
         Ui::SettingsWindow *ui;
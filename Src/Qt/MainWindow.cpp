@@ -26,11 +26,13 @@
 #include "Input/SDLControllerDevice.hpp"
 #include "KeyboardDevice.hpp"
 #include "ui_MainWindow.h"
+#include <QActionGroup>
 #include <QFileDialog>
 #include <QKeyEvent>
 #include <QLabel>
 #include <QMenu>
 #include <SDL.h>
+#include <array>
 #include <fmt/format.h>
 #include <string>
 
@@ -59,6 +61,7 @@ namespace QtFrontend {
         setCentralWidget(emulator_widget);
         centralWidget()->hide();
 
+        create_speed_menu();
         connect_slots();
 
         setWindowTitle(QString("Big ComBoy " BCB_VER));
@@ -81,11 +84,19 @@ namespace QtFrontend {
     }
 
     void MainWindow::keyPressEvent(QKeyEvent *event) {
+        if (event->key() == Qt::Key_Backspace && !event->isAutoRepeat()) {
+            emit rewind_held(true);
+        }
+
         keyboard->key_down(event->key());
         event->accept();
     }
 
     void MainWindow::keyReleaseEvent(QKeyEvent *event) {
+        if (event->key() == Qt::Key_Backspace && !event->isAutoRepeat()) {
+            emit rewind_held(false);
+        }
+
         keyboard->key_up(event->key());
         event->accept();
     }
@@ -132,6 +143,8 @@ namespace QtFrontend {
             settings->raise();
             settings->activateWindow();
             connect(settings, &QDialog::finished, this, &MainWindow::clear_settings_ptr);
+            connect(settings, &SettingsWindow::changes_applied, this,
+                    [this] { emit config_changed(Common::Config::current().gameboy); });
         }
     }
 
@@ -178,6 +191,24 @@ namespace QtFrontend {
         connect(ui->actionAbout, &QAction::triggered, this, &MainWindow::open_about);
     }
 
+    void MainWindow::create_speed_menu() {
+        constexpr std::array<float, 6> SPEEDS{0.25f, 0.5f, 1.0f, 2.0f, 4.0f, 8.0f};
+
+        QMenu *menu = ui->menuEmulation->addMenu(tr("Speed"));
+        QActionGroup *group = new QActionGroup(menu);
+
+        for (float speed : SPEEDS) {
+            QAction *act = menu->addAction(QString::fromStdString(fmt::format("{}x", speed)));
+            act->setCheckable(true);
+            act->setChecked(speed == 1.0f);
+            act->setData(speed);
+            group->addAction(act);
+        }
+
+        connect(group, &QActionGroup::triggered, this,
+                [this](QAction *action) { emit speed_changed(action->data().toFloat()); });
+    }
+
     void MainWindow::reload_recent_roms() {
         for (QAction *act : ui->menuLoad_Recent->actions()) {
             delete act;
@@ -17,6 +17,7 @@
 */
 
 #pragma once
+#include "Common/Config.hpp"
 #include <QMainWindow>
 #include <QTimer>
 #include <filesystem>
@@ -69,10 +70,15 @@ namespace QtFrontend {
         Q_SLOT void rom_load_fail(const QString &message, int timeout = 0);
 
         Q_SIGNAL void rom_loaded(std::filesystem::path);
+        Q_SIGNAL void speed_changed(float multiplier);
         Q_SIGNAL void reload_device_list();
+        Q_SIGNAL void config_changed(const Common::GBConfig &config);
+        // Backspace held or released, the rewind key is fixed and not part of the mappings
+        Q_SIGNAL void rewind_held(bool held);
 
     private:
         void connect_slots();
+        void create_speed_menu();
         void reload_recent_roms();
         void update_controllers();
         void reload_controllers();
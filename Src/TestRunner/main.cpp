@@ -0,0 +1,376 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Common/ThreadPool.hpp"
+#include "Cores/GB/Core.hpp"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// Runs a directory of test ROMs, each on its own core, and decides pass or fail from what the
+// ROM reports: Blargg tests print "Passed" or "Failed" over the serial port, Mooneye tests load
+// the Fibonacci numbers 3, 5, 8, 13, 21, 34 into B-L (0x42 on failure) and send them over
+// serial, and anything else (the acid2 tests) is compared against a hash from a manifest.
+//
+// With --instances every ROM also runs on several cores at once, any difference between the
+// copies means state leaked between cores running on different threads.
+
+struct Options {
+    std::filesystem::path rom_directory;
+    std::filesystem::path manifest_path;
+    std::string filter;
+    int32_t frames = 60 * 60;
+    size_t instances = 1;
+    size_t threads = std::thread::hardware_concurrency();
+};
+
+enum class Outcome { Pass, Fail, Timeout, Error, Mismatch };
+
+struct TestCase {
+    std::filesystem::path path;
+    std::optional<uint64_t> expected_hash;
+};
+
+struct TestResult {
+    Outcome outcome = Outcome::Error;
+    double seconds = 0.0;
+    int32_t frames = 0;
+    uint64_t fingerprint = 0;
+    std::string detail;
+};
+
+constexpr std::array<uint8_t, 6> MOONEYE_PASS{3, 5, 8, 13, 21, 34};
+constexpr std::array<uint8_t, 6> MOONEYE_FAIL{0x42, 0x42, 0x42, 0x42, 0x42, 0x42};
+
+void print_usage() {
+    std::puts("usage: BigComBoyTestRunner <rom directory> [options]\n"
+              "  --manifest <path> expected frame hashes, \"<rom path> <hash>\" per line\n"
+              "                    (default manifest.txt in the ROM directory)\n"
+              "  --frames <n>      frames to run before giving up (default 3600)\n"
+              "  --threads <n>     tests run at once (default one per hardware thread)\n"
+              "  --instances <n>   run every ROM on n cores at once and compare them\n"
+              "  --filter <text>   only run ROMs whose path contains text");
+}
+
+std::optional<Options> parse_arguments(int argc, char *argv[]) {
+    Options options{};
+
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        bool has_value = i + 1 < argc;
+
+        if (arg == "--manifest" && has_value) {
+            options.manifest_path = argv[++i];
+        } else if (arg == "--frames" && has_value) {
+            options.frames = std::atoi(argv[++i]);
+        } else if (arg == "--threads" && has_value) {
+            options.threads = static_cast<size_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--instances" && has_value) {
+            options.instances = static_cast<size_t>(std::max(std::atoi(argv[++i]), 1));
+        } else if (arg == "--filter" && has_value) {
+            options.filter = argv[++i];
+        } else if (!arg.starts_with("--") && options.rom_directory.empty()) {
+            options.rom_directory = arg;
+        } else {
+            return std::nullopt;
+        }
+    }
+
+    if (options.rom_directory.empty() || options.frames <= 0) {
+        return std::nullopt;
+    }
+
+    if (options.manifest_path.empty()) {
+        options.manifest_path = options.rom_directory / "manifest.txt";
+    }
+
+    return options;
+}
+
+// Paths in the manifest are relative to the ROM directory, hashes are the FNV-1a of the
+// framebuffer as printed by this runner and the headless runner's --hashes
+std::map<std::filesystem::path, uint64_t> load_manifest(const std::filesystem::path &path) {
+    std::map<std::filesystem::path, uint64_t> hashes{};
+    std::ifstream file(path);
+    std::string line;
+
+    while (std::getline(file, line)) {
+        std::istringstream tokens(line.substr(0, line.find('#')));
+        std::string rom, hash;
+
+        if (tokens >> rom >> hash) {
+            hashes[std::filesystem::path(rom).lexically_normal()] =
+                std::strtoull(hash.c_str(), nullptr, 16);
+        }
+    }
+
+    return hashes;
+}
+
+uint64_t hash_frame(std::span<const uint8_t> pixels, uint64_t hash = 0xCBF29CE484222325) {
+    for (uint8_t byte : pixels) {
+        hash = (hash ^ byte) * 0x100000001B3;
+    }
+
+    return hash;
+}
+
+bool is_test_rom(const std::filesystem::path &path) {
+    auto extension = path.extension();
+    return extension == ".gb" || extension == ".gbc";
+}
+
+std::string last_line(std::string_view text) {
+    while (!text.empty() && (text.back() == '\n' || text.back() == ' ')) {
+        text.remove_suffix(1);
+    }
+
+    auto start = text.rfind('\n');
+    return std::string(start == std::string_view::npos ? text : text.substr(start + 1));
+}
+
+std::optional<Outcome> check_serial(const std::string &output) {
+    std::string_view bytes = output;
+
+    if (bytes.size() >= MOONEYE_PASS.size()) {
+        auto tail = bytes.substr(bytes.size() - MOONEYE_PASS.size());
+
+        if (std::equal(tail.begin(), tail.end(), MOONEYE_PASS.begin())) {
+            return Outcome::Pass;
+        } else if (std::equal(tail.begin(), tail.end(), MOONEYE_FAIL.begin())) {
+            return Outcome::Fail;
+        }
+    }
+
+    if (output.find("Failed") != std::string::npos) {
+        return Outcome::Fail;
+    } else if (output.find("Passed") != std::string::npos) {
+        return Outcome::Pass;
+    }
+
+    return std::nullopt;
+}
+
+std::optional<Outcome> check_registers(const GB::SM83 &cpu) {
+    using GB::Register;
+    const std::array<uint8_t, 6> values{
+        cpu.get_register(Register::B), cpu.get_register(Register::C),
+        cpu.get_register(Register::D), cpu.get_register(Register::E),
+        cpu.get_register(Register::H), cpu.get_register(Register::L),
+    };
+
+    if (values == MOONEYE_PASS) {
+        return Outcome::Pass;
+    } else if (values == MOONEYE_FAIL) {
+        return Outcome::Fail;
+    }
+
+    return std::nullopt;
+}
+
+TestResult run_test(const TestCase &test, int32_t max_frames, bool fingerprint) {
+    TestResult result{};
+    auto start = std::chrono::steady_clock::now();
+    auto cart = GB::Cartridge::from_file(test.path);
+
+    if (!cart) {
+        result.detail = "unable to load";
+        return result;
+    }
+
+    auto core = std::make_unique<GB::Core>();
+    std::string serial_output;
+    uint64_t hash = 0;
+
+    // Only hash tests and instance comparisons need the pixels
+    core->ppu.set_render_enabled(test.expected_hash.has_value() || fingerprint);
+    core->set_audio_mode(GB::AudioMode::Silent);
+    core->bus.set_serial_callback([&serial_output](uint8_t value) { serial_output += value; });
+    core->initialize(cart.get());
+
+    result.outcome = Outcome::Timeout;
+
+    while (result.frames < max_frames) {
+        core->run_for_frames(1);
+        ++result.frames;
+
+        std::optional<Outcome> outcome{};
+
+        if (test.expected_hash) {
+            hash = hash_frame(core->ppu.framebuffer());
+
+            if (hash == *test.expected_hash) {
+                outcome = Outcome::Pass;
+            }
+        } else {
+            outcome = check_serial(serial_output);
+
+            if (!outcome) {
+                outcome = check_registers(core->cpu);
+            }
+        }
+
+        if (outcome) {
+            result.outcome = *outcome;
+            break;
+        }
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    result.seconds = std::chrono::duration<double>(end - start).count();
+
+    if (fingerprint) {
+        std::span serial(reinterpret_cast<const uint8_t *>(serial_output.data()),
+                         serial_output.size());
+        result.fingerprint = hash_frame(serial, hash_frame(core->ppu.framebuffer()));
+    }
+
+    if (result.outcome != Outcome::Pass) {
+        if (test.expected_hash) {
+            char text[40];
+            std::snprintf(text, sizeof(text), "frame hash %016llx",
+                          static_cast<unsigned long long>(hash));
+            result.detail = text;
+        } else {
+            result.detail = last_line(serial_output);
+        }
+    }
+
+    return result;
+}
+
+const char *outcome_name(Outcome outcome) {
+    switch (outcome) {
+    case Outcome::Pass:
+        return "PASS";
+    case Outcome::Fail:
+        return "FAIL";
+    case Outcome::Timeout:
+        return "TIMEOUT";
+    case Outcome::Mismatch:
+        return "MISMATCH";
+    default:
+        return "ERROR";
+    }
+}
+
+int main(int argc, char *argv[]) {
+    auto options = parse_arguments(argc, argv);
+
+    if (!options) {
+        print_usage();
+        return EXIT_FAILURE;
+    }
+
+    auto manifest = load_manifest(options->manifest_path);
+    std::vector<TestCase> tests{};
+    std::error_code error{};
+
+    for (std::filesystem::recursive_directory_iterator it(options->rom_directory, error), end;
+         !error && it != end; it.increment(error)) {
+        const auto &path = it->path();
+        auto relative = path.lexically_relative(options->rom_directory).lexically_normal();
+
+        if (!it->is_regular_file() || !is_test_rom(path) ||
+            relative.string().find(options->filter) == std::string::npos) {
+            continue;
+        }
+
+        TestCase test{path, std::nullopt};
+
+        if (auto expected = manifest.find(relative); expected != manifest.end()) {
+            test.expected_hash = expected->second;
+        }
+
+        tests.push_back(std::move(test));
+    }
+
+    if (error || tests.empty()) {
+        std::fprintf(stderr, "No test ROMs found in '%s'\n",
+                     options->rom_directory.string().c_str());
+        return EXIT_FAILURE;
+    }
+
+    std::sort(tests.begin(), tests.end(),
+              [](const auto &a, const auto &b) { return a.path < b.path; });
+
+    const size_t instances = options->instances;
+    std::vector<TestResult> results(tests.size() * instances);
+    auto start = std::chrono::steady_clock::now();
+
+    {
+        Common::ThreadPool pool(options->threads);
+
+        // Each job only touches its own result, copies of a test are queued next to each other
+        // so they tend to run at the same time
+        for (size_t i = 0; i < results.size(); ++i) {
+            pool.submit([&, i] {
+                results[i] = run_test(tests[i / instances], options->frames, instances > 1);
+            });
+        }
+
+        pool.wait();
+    }
+
+    auto end = std::chrono::steady_clock::now();
+    size_t passed = 0;
+
+    for (size_t i = 0; i < tests.size(); ++i) {
+        auto result = results[i * instances];
+
+        for (size_t copy = 1; copy < instances; ++copy) {
+            const auto &other = results[i * instances + copy];
+
+            if (other.outcome != result.outcome || other.frames != result.frames ||
+                other.fingerprint != result.fingerprint) {
+                result.outcome = Outcome::Mismatch;
+                result.detail = "instance " + std::to_string(copy) + " ended in a different state";
+                break;
+            }
+        }
+
+        auto relative = tests[i].path.lexically_relative(options->rom_directory);
+
+        std::printf("%-7s %7.2fs %6d frames  %s\n", outcome_name(result.outcome), result.seconds,
+                    result.frames, relative.string().c_str());
+
+        if (!result.detail.empty()) {
+            std::printf("        %s\n", result.detail.c_str());
+        }
+
+        passed += result.outcome == Outcome::Pass;
+    }
+
+    double seconds = std::chrono::duration<double>(end - start).count();
+    std::printf("%zu of %zu passed in %.2fs\n", passed, tests.size(), seconds);
+
+    return passed == tests.size() ? EXIT_SUCCESS : EXIT_FAILURE;
+}
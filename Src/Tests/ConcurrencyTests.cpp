@@ -0,0 +1,95 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Cores/GB/Core.hpp"
+#include "Tests.hpp"
+#include <thread>
+
+namespace {
+    // Mixes DIV into VRAM and WRAM forever, so the picture depends on CPU, timer and PPU timing
+    constexpr uint8_t DIV_TO_VRAM[] = {
+        0x21, 0x00, 0x80, // LD HL,0x8000
+        0xF0, 0x04,       // loop: LDH A,(0x04)
+        0x85,             // ADD A,L
+        0x22,             // LD (HL+),A
+        0x47,             // LD B,A
+        0x7C,             // LD A,H
+        0xFE, 0xA0,       // CP 0xA0
+        0x20, 0x03,       // JR NZ,skip
+        0x21, 0x00, 0x80, // LD HL,0x8000
+        0x78,             // skip: LD A,B
+        0xEA, 0x00, 0xC0, // LD (0xC000),A
+        0x18, 0xED,       // JR loop
+    };
+
+    constexpr size_t INSTANCES = 8;
+    constexpr int32_t FRAMES = 60;
+
+    uint64_t fnv1a(uint64_t hash, uint8_t byte) { return (hash ^ byte) * 0x100000001B3ull; }
+
+    uint64_t run_and_fingerprint(GB::Cartridge &cart) {
+        GB::Core core;
+        core.set_audio_mode(GB::AudioMode::Silent);
+        core.initialize(&cart);
+        core.run_for_frames(FRAMES);
+
+        uint64_t hash = 0xCBF29CE484222325ull;
+
+        for (auto byte : core.ppu.framebuffer()) {
+            hash = fnv1a(hash, byte);
+        }
+
+        for (uint32_t address = 0xC000; address < 0xE000; ++address) {
+            hash = fnv1a(hash, core.bus.read(static_cast<uint16_t>(address)));
+        }
+
+        return fnv1a(hash, static_cast<uint8_t>(core.elapsed_cycles()));
+    }
+
+    // Every core shares the one ROM image, any difference between them means state leaked
+    // between cores on different threads
+    void concurrent_cores_match() {
+        auto cart = GB::Cartridge::from_memory(Tests::make_rom(DIV_TO_VRAM));
+        BCB_CHECK(cart);
+
+        std::vector<std::unique_ptr<GB::Cartridge>> carts{};
+
+        for (size_t i = 0; i < INSTANCES; ++i) {
+            carts.push_back(cart->share_image());
+            BCB_CHECK(carts.back());
+        }
+
+        const uint64_t expected = run_and_fingerprint(*cart);
+        std::vector<uint64_t> results(INSTANCES, 0);
+        std::vector<std::thread> threads{};
+
+        for (size_t i = 0; i < INSTANCES; ++i) {
+            threads.emplace_back([&, i] { results[i] = run_and_fingerprint(*carts[i]); });
+        }
+
+        for (auto &thread : threads) {
+            thread.join();
+        }
+
+        for (auto result : results) {
+            BCB_CHECK(result == expected);
+        }
+    }
+
+    Tests::Register cores_match("concurrent_cores_match", concurrent_cores_match);
+}
@@ -0,0 +1,223 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Cores/GB/Core.hpp"
+#include "Tests.hpp"
+#include <algorithm>
+
+namespace {
+    constexpr uint16_t ROUTINE_ADDRESS = 0x0300;
+
+    // Results the HRAM routine leaves behind, past the end of its code
+    constexpr uint16_t PROBE = 0xFFF0, PROBE_IO = 0xFFF1, PROBE_HRAM = 0xFFF2;
+
+    // Copies the routine at ROUTINE_ADDRESS to HRAM and calls it, with 0xC100 set to 0x5A,
+    // 0xC000 to 0x77 and BGP to 0xE4
+    constexpr uint8_t CALL_FROM_HRAM[] = {
+        0x3E, 0xE4,       // LD A,0xE4
+        0xE0, 0x47,       // LDH (0x47),A
+        0x3E, 0x5A,       // LD A,0x5A
+        0xEA, 0x00, 0xC1, // LD (0xC100),A
+        0x3E, 0x77,       // LD A,0x77
+        0xEA, 0x00, 0xC0, // LD (0xC000),A
+        0x21, 0x00, 0x03, // LD HL,ROUTINE_ADDRESS
+        0x0E, 0x80,       // LD C,0x80
+        0x06, 0x70,       // LD B,0x70
+        0x2A,             // loop: LD A,(HL+)
+        0xE2,             // LDH (C),A
+        0x0C,             // INC C
+        0x05,             // DEC B
+        0x20, 0xFA,       // JR NZ,loop
+        0xCD, 0x80, 0xFF, // CALL 0xFF80
+        0x18, 0xFE,       // JR -2
+    };
+
+    // Starts OAM DMA from 0xC000 and after delay M-cycles reads 0xC100, then IO and HRAM,
+    // then writes 0x11 to 0xC100 and waits out the transfer before returning
+    std::vector<uint8_t> probe_routine(int32_t delay) {
+        std::vector<uint8_t> code = {
+            0x21, 0x00, 0xC1, // LD HL,0xC100
+            0x3E, 0xC0,       // LD A,0xC0
+            0xE0, 0x46,       // LDH (0x46),A
+        };
+
+        // LD B,n and a DEC B, JR NZ loop take 4n+1 M-cycles, NOPs make up the rest
+        if (delay >= 5) {
+            int32_t loops = (delay - 1) / 4;
+            code.insert(code.end(), {0x06, static_cast<uint8_t>(loops), 0x05, 0x20, 0xFD});
+            delay -= loops * 4 + 1;
+        }
+
+        code.insert(code.end(), static_cast<size_t>(delay), 0x00);
+        code.insert(code.end(), {
+                                    0x7E,       // LD A,(HL)
+                                    0xE0, 0xF0, // LDH (PROBE),A
+                                    0xF0, 0x47, // LDH A,(0x47)
+                                    0xE0, 0xF1, // LDH (PROBE_IO),A
+                                    0xF0, 0xF0, // LDH A,(PROBE)
+                                    0xE0, 0xF2, // LDH (PROBE_HRAM),A
+                                    0x36, 0x11, // LD (HL),0x11
+                                    0x06, 0x40, // LD B,0x40
+                                    0x05,       // DEC B
+                                    0x20, 0xFD, // JR NZ,-3
+                                    0xC9,       // RET
+                                });
+        return code;
+    }
+
+    struct Machine {
+        std::unique_ptr<GB::Cartridge> cart;
+        GB::Core core;
+
+        explicit Machine(const std::vector<uint8_t> &rom) {
+            cart = GB::Cartridge::from_memory(rom);
+            BCB_CHECK(cart);
+            core.set_audio_mode(GB::AudioMode::Silent);
+            core.initialize(cart.get());
+        }
+    };
+
+    // The write to FF46 lands at some cycle W. The read of the probe happens 4 * (delay + 2)
+    // cycles later, and the source stays unreachable up to 161 M-cycles after W: one setup
+    // cycle followed by the 160 of the transfer.
+    void oam_dma_access_window() {
+        for (int32_t delay : {0, 1, 2, 3, 100, 141, 142, 158, 159, 160, 161}) {
+            auto rom = Tests::make_rom(CALL_FROM_HRAM);
+            auto routine = probe_routine(delay);
+            std::copy(routine.begin(), routine.end(), rom.begin() + ROUTINE_ADDRESS);
+
+            Machine machine(rom);
+            machine.core.run_for_frames(2);
+            auto &bus = machine.core.bus;
+
+            bool blocked = delay + 2 <= 161;
+            BCB_CHECK(bus.read(PROBE) == (blocked ? 0xFF : 0x5A));
+
+            // The write to 0xC100 happens 18 M-cycles after the probe
+            bool write_blocked = delay + 2 + 18 <= 161;
+            BCB_CHECK(bus.read(0xC100) == (write_blocked ? 0x5A : 0x11));
+
+            // HRAM and IO stay reachable throughout
+            BCB_CHECK(bus.read(PROBE_IO) == 0xE4);
+            BCB_CHECK(bus.read(PROBE_HRAM) == bus.read(PROBE));
+
+            BCB_CHECK(machine.core.ppu.read_oam(0) == 0x77);
+        }
+    }
+
+    // The instruction after the write to FF46 is fetched in the setup cycle and runs. The
+    // fetches after it read 0xFF, an RST 38h each, until the transfer ends and the handler at
+    // 0x38 runs.
+    void oam_dma_setup_cycle() {
+        constexpr uint8_t program[] = {
+            0xAF,       // XOR A
+            0xE0, 0x94, // LDH (0x94),A
+            0x47,       // LD B,A
+            0x3E, 0xC0, // LD A,0xC0
+            0xE0, 0x46, // LDH (0x46),A
+            0x47,       // LD B,A
+            0x18, 0xFE, // JR -2
+        };
+
+        constexpr uint8_t handler[] = {
+            0x78,       // LD A,B
+            0xE0, 0x94, // LDH (0x94),A
+            0x18, 0xFE, // JR -2
+        };
+
+        auto rom = Tests::make_rom(program);
+        std::copy(std::begin(handler), std::end(handler), rom.begin() + 0x38);
+
+        Machine machine(rom);
+        machine.core.run_for_frames(2);
+        BCB_CHECK(machine.core.bus.read(0xFF94) == 0xC0);
+    }
+
+    uint8_t pattern(size_t i) { return static_cast<uint8_t>(i * 7 + 3); }
+
+    // One core copies from WRAM, which is bulk copied, the other from 2 KiB of cartridge RAM,
+    // which only exists in part of its 4 KiB page so every block goes through transfer_block.
+    // Both sources hold the same bytes, the VRAM they write and the cycles they take must match.
+    void check_vram_dma(bool hblank, uint16_t wram_source, uint16_t cart_source, uint16_t length) {
+        auto rom = Tests::make_rom({}, {.mbc_type = 0x02, .ram_size = 0x01});
+        Machine bulk(rom), blockwise(rom);
+        constexpr uint16_t destination = 0x8010;
+
+        // Bank 2 keeps 0xD000 away from the end of bank 0, so a copy across it has to split
+        bulk.core.bus.write(0xFF70, 0x02);
+        blockwise.cart->write(0x0000, 0x0A);
+
+        BCB_CHECK(bulk.core.bus.memory_pointer(wram_source));
+        BCB_CHECK(!blockwise.core.bus.memory_pointer(cart_source));
+
+        for (uint16_t i = 0; i < length; ++i) {
+            bulk.core.bus.write(wram_source + i, pattern(i));
+            blockwise.core.bus.write(cart_source + i, pattern(i));
+        }
+
+        uint64_t taken[2] = {};
+        Machine *machines[] = {&bulk, &blockwise};
+        uint16_t sources[] = {wram_source, cart_source};
+
+        for (int32_t i = 0; i < 2; ++i) {
+            auto &core = machines[i]->core;
+            auto &dma = core.dma;
+            uint8_t blocks = static_cast<uint8_t>(length / 16 - 1);
+
+            // VRAM is only left open with the LCD off
+            core.ppu.write_register(0x40, 0x00);
+            dma.set_hdma1(sources[i] >> 8);
+            dma.set_hdma2(sources[i] & 0xFF);
+            dma.set_hdma3(destination >> 8);
+            dma.set_hdma4(destination & 0xFF);
+
+            uint64_t start = core.elapsed_cycles();
+            dma.set_dma_control(hblank ? (0x80 | blocks) : blocks);
+
+            while (hblank && !(dma.get_dma_status() & 0x80)) {
+                dma.on_hblank();
+                dma.run_hblank_transfer();
+            }
+
+            taken[i] = core.elapsed_cycles() - start;
+            BCB_CHECK(dma.get_dma_status() == 0xFF);
+        }
+
+        BCB_CHECK(taken[0] == taken[1]);
+        BCB_CHECK(taken[0] == static_cast<uint64_t>(length / 16) * 32);
+
+        for (uint16_t i = 0; i < length; ++i) {
+            uint16_t address = (destination + i) & 0x1FFF;
+            BCB_CHECK(bulk.core.ppu.read_vram(address) == pattern(i));
+            BCB_CHECK(blockwise.core.ppu.read_vram(address) == pattern(i));
+        }
+    }
+
+    void vram_dma_bulk_matches_blocks() {
+        for (bool hblank : {false, true}) {
+            check_vram_dma(hblank, 0xC000, 0xA000, 0x800);
+            // Crosses from WRAM bank 0 into the switchable bank, which is not next to it
+            check_vram_dma(hblank, 0xCF80, 0xA380, 0x100);
+        }
+    }
+
+    Tests::Register access_window("oam_dma_access_window", oam_dma_access_window);
+    Tests::Register setup_cycle("oam_dma_setup_cycle", oam_dma_setup_cycle);
+    Tests::Register bulk_matches_blocks("vram_dma_bulk_matches_blocks",
+                                        vram_dma_bulk_matches_blocks);
+}
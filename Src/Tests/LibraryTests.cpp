@@ -0,0 +1,60 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Library/RomLibrary.hpp"
+#include "Tests.hpp"
+#include <fstream>
+
+namespace {
+    // A second library reading the index back has to find every file it describes unchanged
+    void library_rescan_reuses_index() {
+        auto directory = std::filesystem::temp_directory_path() / "bcb_library_test";
+        std::filesystem::remove_all(directory);
+        std::filesystem::create_directories(directory / "nested");
+
+        for (uint8_t i = 0; i < 3; ++i) {
+            const uint8_t program[] = {0x3E, i, 0x18, 0xFE}; // LD A,i; JR -2
+            auto rom = Tests::make_rom(program);
+            auto path = directory / (i ? "nested" : "") / ("rom" + std::to_string(i) + ".gb");
+            std::ofstream(path, std::ios::binary)
+                .write(reinterpret_cast<const char *>(rom.data()), rom.size());
+        }
+
+        const std::filesystem::path directories[] = {directory};
+        auto index = directory / "library.idx";
+        Common::ThreadPool pool(2);
+
+        {
+            Library::RomLibrary library(index);
+            auto result = library.scan(directories, pool);
+            BCB_CHECK(result.hashed == 3 && result.reused == 0);
+            BCB_CHECK(library.save_index());
+        }
+
+        Library::RomLibrary library(index);
+        BCB_CHECK(library.load_index());
+        auto result = library.scan(directories, pool);
+        BCB_CHECK(result.reused == 3 && result.hashed == 0 && result.skipped == 0);
+        BCB_CHECK(library.entries().size() == 3);
+
+        std::filesystem::remove_all(directory);
+    }
+
+    Tests::Register rescan_reuses_index("library_rescan_reuses_index",
+                                        library_rescan_reuses_index);
+}
@@ -0,0 +1,94 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Batch/LockstepGroup.hpp"
+#include "Tests.hpp"
+#include <algorithm>
+#include <fstream>
+
+namespace {
+    // Adds the d-pad lines to 0xC000 forever, so held buttons show up in WRAM
+    constexpr uint8_t PAD_SUM[] = {
+        0x3E, 0x20,       // LD A,0x20
+        0xE0, 0x00,       // LDH (0x00),A
+        0xF0, 0x00,       // loop: LDH A,(0x00)
+        0x21, 0x00, 0xC0, // LD HL,0xC000
+        0x86,             // ADD A,(HL)
+        0x77,             // LD (HL),A
+        0x18, 0xF7,       // JR loop
+    };
+
+    void run_with_buttons(GB::Core &core, uint8_t buttons, int32_t frames) {
+        core.pad.clear_buttons();
+
+        for (int32_t i = 0; i < 8; ++i) {
+            core.pad.set_pad_state(static_cast<GB::PadButton>(i), buttons & (1 << i));
+        }
+
+        core.run_for_frames(frames);
+    }
+
+    // States are not compared byte for byte, they carry the padding of the structs they copy
+    std::vector<uint8_t> work_ram(GB::Core &core) {
+        std::vector<uint8_t> ram{};
+
+        for (uint32_t address = 0xC000; address < 0xE000; ++address) {
+            ram.push_back(core.bus.read(static_cast<uint16_t>(address)));
+        }
+
+        return ram;
+    }
+
+    void lockstep_fork_matches_direct_run() {
+        auto rom = Tests::make_rom(PAD_SUM);
+        auto path = std::filesystem::temp_directory_path() / "bcb_lockstep_test.gb";
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char *>(rom.data()), rom.size());
+
+        Batch::LockstepGroup group(3);
+        BCB_CHECK(group.load(path));
+        group.run_for_frames(20);
+        group.set_buttons(1, 0x0F);
+        group.set_buttons(2, 0x0F);
+        group.run_for_frames(20);
+        std::filesystem::remove(path);
+
+        BCB_CHECK(group.executions() == 2);
+        BCB_CHECK(&group.core(1) == &group.core(2));
+        BCB_CHECK(group.core(0).bus.read(0xC000) != group.core(1).bus.read(0xC000));
+
+        auto cart = GB::Cartridge::from_memory(rom);
+        BCB_CHECK(cart);
+
+        for (uint8_t buttons : {uint8_t(0x00), uint8_t(0x0F)}) {
+            GB::Core core;
+            core.set_audio_mode(GB::AudioMode::Silent);
+            core.initialize(cart.get());
+            run_with_buttons(core, 0x00, 20);
+            run_with_buttons(core, buttons, 20);
+
+            auto &lane = group.core(buttons ? 1 : 0);
+            BCB_CHECK(lane.elapsed_cycles() == core.elapsed_cycles());
+            BCB_CHECK(work_ram(lane) == work_ram(core));
+            BCB_CHECK(std::ranges::equal(lane.ppu.framebuffer(), core.ppu.framebuffer()));
+        }
+    }
+
+    Tests::Register fork_matches("lockstep_fork_matches_direct_run",
+                                 lockstep_fork_matches_direct_run);
+}
@@ -0,0 +1,64 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Cores/GB/AudioMixer.hpp"
+#include "Tests.hpp"
+#include <cmath>
+
+namespace {
+    // Every channel at 15 with NR50 at 7 on both sides
+    GB::SampleBlock full_scale_block() {
+        GB::SampleBlock block;
+        block.resize(16);
+
+        GB::SampleResult result{};
+        result.left_channel = {7, 0, 15, 15, 15, 15};
+        result.right_channel = {7, 0, 15, 15, 15, 15};
+
+        while (!block.full()) {
+            block.push(result);
+        }
+
+        return block;
+    }
+
+    // The capacitor starts empty, so the first frame is the mix before any filtering
+    void check_full_scale(void (GB::AudioMixer::*mix)(const GB::SampleBlock &,
+                                                     const GB::MixerSettings &, std::span<float>)) {
+        auto block = full_scale_block();
+        std::vector<float> output(block.size() * 2);
+
+        GB::AudioMixer mixer;
+        mixer.set_sample_rate(48000);
+        (mixer.*mix)(block, GB::MixerSettings{}, output);
+
+        constexpr float expected = 4.0f * 15.0f / 255.0f;
+        BCB_CHECK(std::abs(output[0] - expected) < 1e-5f);
+        BCB_CHECK(std::abs(output[1] - expected) < 1e-5f);
+
+        // Later frames only decay through the high-pass filter
+        BCB_CHECK(output[2] <= output[0] && output[2] > 0.0f);
+    }
+
+    void mixer_full_scale() {
+        check_full_scale(&GB::AudioMixer::mix);
+        check_full_scale(&GB::AudioMixer::mix_scalar);
+    }
+
+    Tests::Register full_scale("mixer_full_scale", mixer_full_scale);
+}
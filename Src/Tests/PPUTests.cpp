@@ -0,0 +1,77 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Cores/GB/Core.hpp"
+#include "Tests.hpp"
+
+namespace {
+    constexpr uint8_t LCDC = 0x40, STAT = 0x41, SCX = 0x43, WY = 0x4A, WX = 0x4B;
+
+    // Cycles the first line after the LCD is turned on spends in mode 3, the PPU is stepped on
+    // its own
+    int32_t mode3_cycles(uint8_t lcdc, uint8_t scx, uint8_t wx, bool frame_skip) {
+        constexpr uint8_t loop[] = {0x18, 0xFE}; // JR -2
+        auto cart = GB::Cartridge::from_memory(Tests::make_rom(loop));
+        BCB_CHECK(cart);
+
+        GB::Core core;
+        core.set_audio_mode(GB::AudioMode::Silent);
+        core.initialize(cart.get());
+
+        core.ppu.set_frame_skip(frame_skip);
+        core.ppu.write_register(LCDC, 0);
+        core.ppu.step(1);
+        core.ppu.write_register(SCX, scx);
+        core.ppu.write_register(WY, 0);
+        core.ppu.write_register(WX, wx);
+        core.ppu.write_register(LCDC, lcdc);
+
+        int32_t cycles = 0;
+
+        for (int32_t i = 0; i < 456 * 2; ++i) {
+            core.ppu.step(1);
+
+            if ((core.ppu.read_register(STAT) & 0x3) == 3) {
+                ++cycles;
+            } else if (cycles) {
+                break;
+            }
+        }
+
+        return cycles;
+    }
+
+    void ppu_frame_skip_mode3() {
+        constexpr uint8_t BG_ONLY = 0x91, WITH_WINDOW = 0xB1;
+
+        for (uint8_t scx = 0; scx < 8; ++scx) {
+            int32_t drawn = mode3_cycles(BG_ONLY, scx, 0, false);
+            BCB_CHECK(drawn > 0);
+            BCB_CHECK(mode3_cycles(BG_ONLY, scx, 0, true) == drawn);
+
+            for (uint8_t wx : {uint8_t(0), uint8_t(7), uint8_t(8), uint8_t(80)}) {
+                BCB_CHECK(mode3_cycles(WITH_WINDOW, scx, wx, true) ==
+                          mode3_cycles(WITH_WINDOW, scx, wx, false));
+            }
+        }
+
+        BCB_CHECK(mode3_cycles(BG_ONLY, 5, 0, true) == mode3_cycles(BG_ONLY, 0, 0, true) + 5);
+    }
+
+    Tests::Register frame_skip_mode3("ppu_frame_skip_mode3", ppu_frame_skip_mode3);
+}
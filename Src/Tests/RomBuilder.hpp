@@ -0,0 +1,62 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include <algorithm>
+#include <cinttypes>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Tests {
+    // Where make_rom places the program, after the prologue
+    constexpr size_t PROGRAM_ADDRESS = 0x154;
+
+    struct RomOptions {
+        uint8_t mbc_type = 0x00;
+        uint8_t ram_size = 0x00;
+    };
+
+    // 32 KiB image that starts running program at 0x150 with interrupts disabled and SP at
+    // 0xDFFE. The program has to loop on its own. Shared by the tests and the benchmarks.
+    inline std::vector<uint8_t> make_rom(std::span<const uint8_t> program,
+                                         RomOptions options = {}) {
+        std::vector<uint8_t> rom(0x8000, 0);
+
+        const uint8_t entry[] = {0x00, 0xC3, 0x50, 0x01}; // NOP, JP 0x0150
+        std::copy(std::begin(entry), std::end(entry), rom.begin() + 0x100);
+
+        std::string_view title = "BCB TEST";
+        std::copy(title.begin(), title.end(), rom.begin() + 0x134);
+        rom[0x147] = options.mbc_type;
+        rom[0x149] = options.ram_size;
+
+        uint8_t checksum = 0;
+        for (size_t i = 0x134; i < 0x14D; ++i) {
+            checksum = checksum - rom[i] - 1;
+        }
+        rom[0x14D] = checksum;
+
+        // DI, LD SP,0xDFFE
+        const uint8_t prologue[] = {0xF3, 0x31, 0xFE, 0xDF};
+        auto end = std::copy(std::begin(prologue), std::end(prologue), rom.begin() + 0x150);
+        std::copy(program.begin(), program.end(), end);
+
+        return rom;
+    }
+}
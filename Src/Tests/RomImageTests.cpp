@@ -0,0 +1,58 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Cores/GB/RomImage.hpp"
+#include "Tests.hpp"
+#include <fstream>
+
+namespace {
+    void write_file(const std::filesystem::path &path, const std::vector<uint8_t> &bytes) {
+        std::ofstream(path, std::ios::binary)
+            .write(reinterpret_cast<const char *>(bytes.data()), bytes.size());
+    }
+
+    void rom_image_replaced_file() {
+        auto directory = std::filesystem::temp_directory_path();
+        auto path = directory / "bcb_rom_image_test.gb";
+        auto staged = directory / "bcb_rom_image_test.gb.new";
+
+        constexpr uint8_t first[] = {0x00};
+        constexpr uint8_t second[] = {0x76};
+        write_file(path, Tests::make_rom(first));
+
+        auto old_image = GB::RomImage::open(path);
+        BCB_CHECK(old_image);
+        BCB_CHECK(old_image->is_mapped());
+        BCB_CHECK(GB::RomImage::open(path) == old_image);
+
+        // Same size and likely the same time, only the inode tells the files apart
+        write_file(staged, Tests::make_rom(second));
+        std::filesystem::last_write_time(staged, std::filesystem::last_write_time(path));
+        std::filesystem::rename(staged, path);
+
+        auto new_image = GB::RomImage::open(path);
+        BCB_CHECK(new_image && new_image != old_image);
+        BCB_CHECK(!new_image->is_mapped());
+        BCB_CHECK(old_image->bytes()[0x154] == 0x00);
+        BCB_CHECK(new_image->bytes()[0x154] == 0x76);
+
+        std::filesystem::remove(path);
+    }
+
+    Tests::Register replaced_file("rom_image_replaced_file", rom_image_replaced_file);
+}
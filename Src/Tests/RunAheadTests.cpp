@@ -0,0 +1,80 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Cores/GB/Core.hpp"
+#include "Cores/GB/RunAhead.hpp"
+#include "Tests.hpp"
+
+namespace {
+    // MBC1 with 8 KiB of battery RAM the program never touches
+    std::unique_ptr<GB::Cartridge> idle_battery_cart() {
+        constexpr uint8_t loop[] = {0x18, 0xFE}; // JR -2
+        auto cart = GB::Cartridge::from_memory(
+            Tests::make_rom(loop, {.mbc_type = 0x03, .ram_size = 0x02}));
+        BCB_CHECK(cart);
+        return cart;
+    }
+
+    void run_ahead_keeps_save_clean() {
+        auto cart = idle_battery_cart();
+        GB::Core core;
+        core.set_audio_mode(GB::AudioMode::Silent);
+        core.initialize(cart.get());
+
+        std::vector<uint8_t> image;
+        BCB_CHECK(cart->update_save_image(image, true));
+
+        GB::RunAhead run_ahead;
+        run_ahead.set_frames(2);
+        run_ahead.prepare(core);
+
+        for (int32_t i = 0; i < 10; ++i) {
+            run_ahead.run_frame(core);
+            BCB_CHECK(!cart->update_save_image(image, false));
+        }
+    }
+
+    void state_load_marks_changed_pages() {
+        auto cart = idle_battery_cart();
+        GB::Core core;
+        core.set_audio_mode(GB::AudioMode::Silent);
+        core.initialize(cart.get());
+        core.run_for_frames(1);
+
+        std::vector<uint8_t> image, state(core.state_size());
+        BCB_CHECK(cart->update_save_image(image, true));
+        BCB_CHECK(core.save_state(state));
+
+        cart->write(0x0000, 0x0A);
+        cart->write_ram(0x1000, 0x42);
+        BCB_CHECK(cart->update_save_image(image, false));
+        BCB_CHECK(image[0x1000] == 0x42);
+
+        // The written page is put back and has to reach the save file again
+        BCB_CHECK(core.load_state(state));
+        BCB_CHECK(cart->update_save_image(image, false));
+        BCB_CHECK(image[0x1000] == 0x00);
+
+        BCB_CHECK(core.load_state(state));
+        BCB_CHECK(!cart->update_save_image(image, false));
+    }
+
+    Tests::Register keeps_save_clean("run_ahead_keeps_save_clean", run_ahead_keeps_save_clean);
+    Tests::Register marks_changed_pages("state_load_marks_changed_pages",
+                                        state_load_marks_changed_pages);
+}
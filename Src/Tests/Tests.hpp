@@ -0,0 +1,35 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#pragma once
+#include "RomBuilder.hpp"
+#include <string_view>
+
+namespace Tests {
+    using TestFunction = void (*)();
+
+    // Made at namespace scope next to the test, ctest runs each one by name
+    struct Register {
+        Register(std::string_view name, TestFunction function);
+    };
+
+    [[noreturn]] void fail(const char *expression, const char *file, int line);
+}
+
+#define BCB_CHECK(expression)                                                                   \
+    ((expression) ? static_cast<void>(0) : ::Tests::fail(#expression, __FILE__, __LINE__))
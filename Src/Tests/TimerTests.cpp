@@ -0,0 +1,193 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Cores/GB/Core.hpp"
+#include "Tests.hpp"
+
+namespace {
+    constexpr uint8_t DIV = 0x04, TIMA = 0x05, TMA = 0x06, TAC = 0x07;
+    constexpr uint16_t TAC_BITS[] = {512, 8, 32, 128};
+
+    // The 16-bit divider counted every M-cycle. TIMA increments when its input, the enable bit
+    // AND the selected divider bit, falls, whatever made it fall. The frame sequencer steps
+    // when bit 12 falls.
+    struct ReferenceTimer {
+        uint16_t div = 0;
+        uint8_t tima = 0, tma = 0, tac = 0;
+        int32_t interrupts = 0, overflows = 0;
+        int32_t frame_sequencer_steps = 0;
+
+        bool input() const { return (tac & 0x4) && (div & TAC_BITS[tac & 0x3]); }
+
+        void set_div(uint16_t value) {
+            bool was_input = input();
+            bool was_sequencer = div & 0x1000;
+            div = value;
+
+            if (was_sequencer && !(div & 0x1000)) {
+                ++frame_sequencer_steps;
+            }
+
+            if (was_input && !input()) {
+                increment();
+            }
+        }
+
+        void set_tac(uint8_t value) {
+            bool was_input = input();
+            tac = value;
+
+            if (was_input && !input()) {
+                increment();
+            }
+        }
+
+        void increment() {
+            if (++tima == 0) {
+                tima = tma;
+                ++interrupts;
+                ++overflows;
+            }
+        }
+
+        void tick() { set_div(static_cast<uint16_t>(div + 4)); }
+    };
+
+    struct Harness {
+        std::unique_ptr<GB::Cartridge> cart;
+        GB::Core core;
+        ReferenceTimer reference{};
+        uint8_t sequencer_start = 0;
+
+        // DIV is written with the timer off on both sides, so they start from the same state
+        Harness() {
+            constexpr uint8_t loop[] = {0x18, 0xFE}; // JR -2
+            cart = GB::Cartridge::from_memory(Tests::make_rom(loop));
+            BCB_CHECK(cart);
+
+            core.set_audio_mode(GB::AudioMode::Silent);
+            core.initialize(cart.get());
+            write(TAC, 0x00);
+            write(DIV, 0x00);
+            core.bus.write(0xFF0F, 0x00);
+
+            reference = {};
+            sequencer_start = core.apu.frame_sequencer_step();
+        }
+
+        void write(uint8_t reg, uint8_t value) {
+            core.timer.write_register(reg, value);
+
+            switch (reg) {
+            case DIV:
+                reference.set_div(0);
+                break;
+            case TIMA:
+                reference.tima = value;
+                break;
+            case TMA:
+                reference.tma = value;
+                break;
+            case TAC:
+                reference.set_tac(value);
+                break;
+            }
+        }
+
+        void tick(int32_t m_cycles = 1) {
+            while (m_cycles--) {
+                core.tick_subcomponents(4);
+                reference.tick();
+                check();
+            }
+        }
+
+        void check() {
+            BCB_CHECK(core.timer.read_register(TIMA) == reference.tima);
+            BCB_CHECK(core.timer.read_register(DIV) == (reference.div >> 8));
+
+            if (core.bus.read(0xFF0F) & GB::INT_TIMER_BIT) {
+                BCB_CHECK(reference.interrupts == 1);
+                core.bus.write(0xFF0F, 0x00);
+                reference.interrupts = 0;
+            }
+
+            BCB_CHECK(reference.interrupts == 0);
+            BCB_CHECK(core.apu.frame_sequencer_step() ==
+                      ((sequencer_start + reference.frame_sequencer_steps) & 7));
+        }
+    };
+
+    // Every increment and reload lands on the same M-cycle as the divider bit falling
+    void timer_tima_rates() {
+        for (uint8_t rate = 0; rate < 4; ++rate) {
+            Harness harness;
+            harness.write(TMA, 0xF0);
+            harness.write(TIMA, 0xF0);
+            harness.write(TAC, 0x4 | rate);
+
+            // At the slowest rate this still covers a few overflows
+            harness.tick(256 * 40);
+            BCB_CHECK(harness.reference.overflows >= 2);
+        }
+    }
+
+    // Writing DIV or TAC while the selected bit is set makes the input fall and counts once
+    void timer_write_glitches() {
+        for (uint8_t from = 0; from < 8; ++from) {
+            for (uint8_t to = 0; to < 8; ++to) {
+                for (int32_t offset = 0; offset < 300; offset += 7) {
+                    Harness harness;
+                    harness.write(TAC, from);
+                    harness.tick(offset);
+
+                    harness.write(TAC, to);
+                    harness.check();
+                    harness.tick(3);
+
+                    harness.write(DIV, 0);
+                    harness.check();
+                    harness.tick(300);
+                }
+            }
+        }
+    }
+
+    // A DIV write with bit 12 set steps the frame sequencer early, and the next regular step
+    // is a full period after the write
+    void timer_div_reset_frame_sequencer() {
+        for (int32_t offset = 0; offset < 4096; offset += 61) {
+            Harness harness;
+            harness.tick(offset);
+            harness.write(DIV, 0);
+            harness.check();
+            harness.tick(4096);
+        }
+
+        Harness harness;
+        harness.tick(1024 + 10);
+        harness.write(DIV, 0);
+        BCB_CHECK(harness.reference.frame_sequencer_steps == 1);
+        harness.check();
+    }
+
+    Tests::Register tima_rates("timer_tima_rates", timer_tima_rates);
+    Tests::Register write_glitches("timer_write_glitches", timer_write_glitches);
+    Tests::Register div_reset_frame_sequencer("timer_div_reset_frame_sequencer",
+                                              timer_div_reset_frame_sequencer);
+}
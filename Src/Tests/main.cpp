@@ -0,0 +1,66 @@
+/*
+    Big ComBoy
+    Copyright (C) 2023-2024 UltimaOmega474
+
+    This program is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    This program is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <https://www.gnu.org/licenses/>.
+*/
+
+#include "Tests.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <utility>
+
+namespace Tests {
+    static std::vector<std::pair<std::string_view, TestFunction>> &registry() {
+        static std::vector<std::pair<std::string_view, TestFunction>> tests{};
+        return tests;
+    }
+
+    Register::Register(std::string_view name, TestFunction function) {
+        registry().emplace_back(name, function);
+    }
+
+    void fail(const char *expression, const char *file, int line) {
+        std::fprintf(stderr, "%s:%d: check failed: %s\n", file, line, expression);
+        std::exit(EXIT_FAILURE);
+    }
+}
+
+int main(int argc, char *argv[]) {
+    const auto &tests = Tests::registry();
+
+    if (argc != 2) {
+        std::puts("usage: CoreTests <test>\n\ntests:");
+
+        for (const auto &[name, function] : tests) {
+            std::printf("  %.*s\n", static_cast<int>(name.size()), name.data());
+        }
+
+        return EXIT_FAILURE;
+    }
+
+    std::string_view wanted = argv[1];
+    auto test = std::find_if(tests.begin(), tests.end(),
+                             [wanted](const auto &entry) { return entry.first == wanted; });
+
+    if (test == tests.end()) {
+        std::fprintf(stderr, "No test named '%s'\n", argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    test->second();
+    return EXIT_SUCCESS;
+}